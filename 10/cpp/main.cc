@@ -1,15 +1,19 @@
-#include <fstream>
+#include <algorithm>
+#include <array>
 #include <iostream>
-#include <map>
-#include <sstream>
+#include <optional>
 #include <string>
+#include <thread>
 #include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../../shared/cpp/big_uint.h"
 using namespace std;
 
 // MARK: - Models
 
-enum ChunkSide { opening, closing };
-
 enum ChunkType { round, square, curly, angle };
 
 int corruption_points(ChunkType type) {
@@ -23,6 +27,7 @@ int corruption_points(ChunkType type) {
   case angle:
     return 25137;
   }
+  abort();
 }
 
 uint64_t autocomplete_points(ChunkType type) {
@@ -36,132 +41,310 @@ uint64_t autocomplete_points(ChunkType type) {
   case angle:
     return 4;
   }
+  abort();
 }
 
-struct ChunkDelimiter {
-  ChunkSide side;
-  ChunkType type;
+// Every byte maps to one entry: the low two bits hold the `ChunkType`, bit 2
+// is set for closing delimiters and bit 3 for bytes that aren't delimiters.
+typedef uint8_t DelimiterClass;
+
+const DelimiterClass closing_bit = 1 << 2;
+const DelimiterClass invalid_bit = 1 << 3;
+
+array<DelimiterClass, 256> make_delimiter_classes() {
+  array<DelimiterClass, 256> classes;
+  classes.fill(invalid_bit);
+  classes['('] = round;
+  classes['['] = square;
+  classes['{'] = curly;
+  classes['<'] = angle;
+  classes[')'] = closing_bit | round;
+  classes[']'] = closing_bit | square;
+  classes['}'] = closing_bit | curly;
+  classes['>'] = closing_bit | angle;
+  return classes;
+}
+
+const array<DelimiterClass, 256> delimiter_classes = make_delimiter_classes();
+
+// Both scores for one line. At most one of them is non-zero: corrupt lines
+// only score corruption points and incomplete lines only autocomplete points.
+// Lines with more than 27 unclosed chunks can score too much for 64 bits, and
+// their score is kept in full instead.
+struct LineScore {
+  int corruption_points;
+  uint64_t autocomplete_points;
+  optional<BigUint> large_autocomplete_points;
 };
 
-enum RawLineState { valid, incomplete, corrupt };
+// Validates lines straight from their bytes. The stack of open chunks is
+// kept between lines so it only allocates when a line nests deeper than any
+// before it.
+struct Validator {
+  vector<ChunkType> open_types;
 
-struct LineState {
-  RawLineState raw_state;
-  vector<ChunkType> types;
+  LineScore score(const char* begin, const char* end) {
+    if (open_types.size() < (size_t)(end - begin))
+      open_types.resize(end - begin);
 
-  int corruption_points() {
-    switch (raw_state) {
-    case valid:
-      return 0;
-    case incomplete:
-      return 0;
-    case corrupt:
-      return ::corruption_points(types[0]);
+    size_t depth = 0;
+    for (const char* i = begin; i != end; ++i) {
+      DelimiterClass delimiter = delimiter_classes[(uint8_t)*i];
+      ChunkType type = ChunkType(delimiter & 3);
+      if (delimiter & invalid_bit) {
+        abort();
+      } else if (!(delimiter & closing_bit)) {
+        open_types[depth++] = type;
+      } else if (depth > 0 && open_types[depth - 1] == type) {
+        depth--;
+      } else {
+        return {::corruption_points(type), 0, nullopt};
+      }
+    }
+
+    uint64_t result = 0;
+    for (size_t i = depth; i > 0; --i) {
+      if (__builtin_mul_overflow(result, 5, &result) ||
+          __builtin_add_overflow(result, ::autocomplete_points(open_types[i - 1]), &result))
+        return {0, 0, large_autocomplete_points(depth)};
     }
+    return {0, result, nullopt};
   }
 
-  uint64_t autocomplete_points() {
-    switch (raw_state) {
-    case valid:
-      return 0;
-    case corrupt:
-      return 0;
-    case incomplete:
-      uint64_t result = 0;
-      for (auto i = types.rbegin(); i != types.rend(); ++i) {
-        result *= 5;
-        result += ::autocomplete_points(*i);
-      }
-      return result;
+  BigUint large_autocomplete_points(size_t depth) const {
+    BigUint result;
+    while (depth > 0) {
+      result *= 5;
+      result += ::autocomplete_points(open_types[--depth]);
     }
+    return result;
   }
 };
 
-struct Line {
-  vector<ChunkDelimiter> delimiters;
+struct Totals {
+  uint64_t corruption_points = 0;
+  vector<uint64_t> autocomplete_points;
+  // Scores that don't fit in 64 bits, which are all larger than any that do.
+  vector<BigUint> large_autocomplete_points;
 
-  LineState state() {
-    vector<ChunkType> open_types;
-    for (auto d = delimiters.begin(); d != delimiters.end(); ++d) {
-      if (d->side == opening) {
-        open_types.push_back(d->type);
-      } else if (!open_types.empty() && d->type == open_types[open_types.size() - 1]) {
-        open_types.pop_back();
-      } else {
-        return {corrupt, {d->type}};
-      }
+  void add(LineScore score) {
+    corruption_points += score.corruption_points;
+    if (score.large_autocomplete_points.has_value()) {
+      large_autocomplete_points.push_back(move(*score.large_autocomplete_points));
+    } else if (score.autocomplete_points > 0) {
+      autocomplete_points.push_back(score.autocomplete_points);
     }
-
-    return {open_types.empty() ? valid : incomplete, open_types};
   }
 };
 
+// Runs `work(i)` for every `i` below `count`, each on its own thread.
+template <typename Work>
+void for_each_in_parallel(size_t count, Work work) {
+  vector<thread> threads;
+  for (size_t i = 0; i < count; ++i) {
+    threads.emplace_back(work, i);
+  }
+  for (auto t = threads.begin(); t != threads.end(); ++t) {
+    t->join();
+  }
+}
+
 // MARK: - Parsers
 
-ChunkDelimiter parse_delimiter(char input) {
-  switch (input) {
-  case '(':
-    return {opening, round};
-  case '[':
-    return {opening, square};
-  case '{':
-    return {opening, curly};
-  case '<':
-    return {opening, angle};
-  case ')':
-    return {closing, round};
-  case ']':
-    return {closing, square};
-  case '}':
-    return {closing, curly};
-  case '>':
-    return {closing, angle};
-  default:
-    abort();
+Totals score_lines(const char* begin, const char* end) {
+  Totals totals;
+  Validator validator;
+  while (begin != end) {
+    const char* line_end = find(begin, end, '\n');
+    const char* content_end = line_end;
+    if (content_end != begin && content_end[-1] == '\r')
+      content_end--;
+    if (content_end != begin)
+      totals.add(validator.score(begin, content_end));
+    begin = line_end == end ? end : line_end + 1;
   }
+  return totals;
 }
 
-Line parse_line(string input) {
-  vector<ChunkDelimiter> delimiters;
-  for (auto i = input.begin(); i != input.end(); ++i) {
-    delimiters.push_back(parse_delimiter(*i));
+// Splits the buffer on line boundaries and scores each chunk on its own
+// thread, with its own validator and totals.
+vector<Totals> score_lines_in_parallel(const char* begin, const char* end) {
+  const size_t size = end - begin;
+  const size_t min_chunk_size = 1 << 16;
+  size_t thread_count = max<size_t>(1, thread::hardware_concurrency());
+  thread_count = min(thread_count, max<size_t>(1, size / min_chunk_size));
+
+  vector<const char*> boundaries = {begin};
+  for (size_t i = 1; i < thread_count; ++i) {
+    const char* boundary = max(boundaries.back(), begin + size * i / thread_count);
+    boundary = find(boundary, end, '\n');
+    boundaries.push_back(boundary == end ? end : boundary + 1);
+  }
+  boundaries.push_back(end);
+
+  vector<Totals> chunk_totals(thread_count);
+  for_each_in_parallel(thread_count, [&](size_t i) {
+    chunk_totals[i] = score_lines(boundaries[i], boundaries[i + 1]);
+  });
+  return chunk_totals;
+}
+
+// A read-only memory mapping of a whole file.
+struct MappedFile {
+  const char* data = nullptr;
+  size_t size = 0;
+
+  MappedFile(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+      abort();
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+      abort();
+    size = st.st_size;
+    if (size > 0) {
+      void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped == MAP_FAILED)
+        abort();
+      data = (const char*)mapped;
+    }
+    close(fd);
+  }
+
+  ~MappedFile() {
+    if (data != nullptr)
+      munmap((void*)data, size);
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+};
+
+// MARK: - Selection
+
+// The score of rank `rank` among every chunk's scores together, found without
+// merging them. Each round picks a pivot from the middle of each chunk's
+// remaining scores, every chunk partitions those around it on its own thread,
+// and the counts on either side show which side holds the rank, so only that
+// side is kept. Once a single chunk or few enough scores remain, they're
+// selected from directly.
+uint64_t select_in_parallel(vector<vector<uint64_t>*>& chunks, size_t rank) {
+  const size_t min_parallel_size = 1 << 16;
+  struct Range {
+    uint64_t* first;
+    uint64_t* last;
+
+    size_t size() const { return last - first; }
+  };
+  vector<Range> ranges;
+  for (auto c = chunks.begin(); c != chunks.end(); ++c) {
+    if (!(*c)->empty())
+      ranges.push_back({(*c)->data(), (*c)->data() + (*c)->size()});
+  }
+
+  while (true) {
+    size_t remaining = 0;
+    for (auto r = ranges.begin(); r != ranges.end(); ++r)
+      remaining += r->size();
+    if (rank >= remaining)
+      abort();
+    if (ranges.size() == 1) {
+      nth_element(ranges[0].first, ranges[0].first + rank, ranges[0].last);
+      return ranges[0].first[rank];
+    }
+    if (remaining <= min_parallel_size) {
+      vector<uint64_t> scores;
+      for (auto r = ranges.begin(); r != ranges.end(); ++r)
+        scores.insert(scores.end(), r->first, r->last);
+      nth_element(scores.begin(), scores.begin() + rank, scores.end());
+      return scores[rank];
+    }
+
+    vector<uint64_t> candidates;
+    for (auto r = ranges.begin(); r != ranges.end(); ++r)
+      candidates.push_back(r->first[r->size() / 2]);
+    nth_element(candidates.begin(), candidates.begin() + candidates.size() / 2, candidates.end());
+    uint64_t pivot = candidates[candidates.size() / 2];
+
+    vector<size_t> less_counts(ranges.size());
+    vector<size_t> equal_counts(ranges.size());
+    for_each_in_parallel(ranges.size(), [&](size_t i) {
+      Range r = ranges[i];
+      uint64_t* less_end = partition(r.first, r.last, [&](uint64_t score) { return score < pivot; });
+      uint64_t* equal_end = partition(less_end, r.last, [&](uint64_t score) { return score == pivot; });
+      less_counts[i] = less_end - r.first;
+      equal_counts[i] = equal_end - less_end;
+    });
+    size_t less_count = 0;
+    size_t equal_count = 0;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+      less_count += less_counts[i];
+      equal_count += equal_counts[i];
+    }
+
+    if (rank >= less_count && rank < less_count + equal_count)
+      return pivot;
+    vector<Range> kept;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+      Range r = ranges[i];
+      if (rank < less_count) {
+        r.last = r.first + less_counts[i];
+      } else {
+        r.first += less_counts[i] + equal_counts[i];
+      }
+      if (r.size() > 0)
+        kept.push_back(r);
+    }
+    if (rank >= less_count)
+      rank -= less_count + equal_count;
+    ranges = kept;
   }
-  return {delimiters};
 }
 
 // MARK: - Parts 1 & 2
 
-int part1(vector<LineState> line_states) {
-  int sum = 0;
-  for (auto i = line_states.begin(); i != line_states.end(); ++i) {
-    sum += i->corruption_points();
+uint64_t part1(const vector<Totals>& chunk_totals) {
+  uint64_t sum = 0;
+  for (auto t = chunk_totals.begin(); t != chunk_totals.end(); ++t) {
+    sum += t->corruption_points;
   }
   return sum;
 }
 
-uint64_t part2(vector<LineState> line_states) {
-  vector<uint64_t> autocomplete_points;
-  for (auto i = line_states.begin(); i != line_states.end(); ++i) {    
-    uint64_t points = i->autocomplete_points();
-    if (points > 0)
-      autocomplete_points.push_back(points);
+// Selects the median autocomplete score across the chunks in parallel.
+// Scores too large for 64 bits all rank above the rest and are rare, so
+// they're only gathered and searched when the median is among them. Aborts
+// if no line is incomplete.
+BigUint part2(vector<Totals>& chunk_totals) {
+  vector<vector<uint64_t>*> chunks;
+  size_t count = 0;
+  size_t large_count = 0;
+  for (auto t = chunk_totals.begin(); t != chunk_totals.end(); ++t) {
+    chunks.push_back(&t->autocomplete_points);
+    count += t->autocomplete_points.size();
+    large_count += t->large_autocomplete_points.size();
   }
+  if (count + large_count == 0)
+    abort();
 
-  sort(autocomplete_points.begin(), autocomplete_points.end());
-  return autocomplete_points[(autocomplete_points.size() - 1) / 2];
+  size_t median_rank = (count + large_count - 1) / 2;
+  if (median_rank < count)
+    return select_in_parallel(chunks, median_rank);
+  vector<BigUint> large_points;
+  for (auto t = chunk_totals.begin(); t != chunk_totals.end(); ++t)
+    large_points.insert(large_points.end(), t->large_autocomplete_points.begin(), t->large_autocomplete_points.end());
+  auto median = large_points.begin() + (median_rank - count);
+  nth_element(large_points.begin(), median, large_points.end());
+  return *median;
 }
 
 int main() {
   // MARK: - Read Input
 
-  ifstream is("input.txt");
-  string str;
-  vector<LineState> line_states;
-  while(getline(is, str)) {
-    line_states.push_back(parse_line(str).state());
-  }
+  MappedFile input("input.txt");
+  vector<Totals> chunk_totals = score_lines_in_parallel(input.data, input.data + input.size);
 
-  cout << "Part 1: " << part1(line_states) << endl;
-  cout << "Part 2: " << part2(line_states) << endl;
+  cout << "Part 1: " << part1(chunk_totals) << endl;
+  cout << "Part 2: " << part2(chunk_totals) << endl;
   return 0;
 }
@@ -1,6 +1,6 @@
 #include <fstream>
 #include <iostream>
-#include <map>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -8,57 +8,10 @@ using namespace std;
 
 // MARK: - Models
 
-enum EnergyLevel { zero, one, two, three, four, five, six, seven, eight, nine };
-
-EnergyLevel increase_energy_level(EnergyLevel level) {
-  switch (level) {
-  case zero:
-    return one;
-  case one:
-    return two;
-  case two:
-    return three;
-  case three:
-    return four;
-  case four:
-    return five;
-  case five:
-    return six;
-  case six:
-    return seven;
-  case seven:
-    return eight;
-  case eight:
-    return nine;
-  case nine:
-    return zero;
-  }
-}
+typedef uint8_t EnergyLevel;
 
-int raw_energy_level(EnergyLevel level) {
-  switch (level) {
-  case zero:
-    return 0;
-  case one:
-    return 1;
-  case two:
-    return 2;
-  case three:
-    return 3;
-  case four:
-    return 4;
-  case five:
-    return 5;
-  case six:
-    return 6;
-  case seven:
-    return 7;
-  case eight:
-    return 8;
-  case nine:
-    return 9;
-  }
-}
+const EnergyLevel max_energy_level = 9;
+const EnergyLevel flashed = max_energy_level + 1;
 
 struct Line {
   vector<EnergyLevel> levels;
@@ -67,143 +20,179 @@ struct Line {
 struct Point {
   int x;
   int y;
+};
 
-  bool operator <(const Point& rhs) const {
-    return x < rhs.x || (x == rhs.x && y < rhs.y);
-  }
+// Energy levels stored row-major with a one-cell border on every side. An
+// octopus that has flashed during the current step sits at `flashed` or
+// above until the step ends, and the border is permanently `flashed`, so
+// neither is ever increased by a neighboring flash.
+struct Grid {
+  int width;
+  int height;
+  vector<EnergyLevel> cells;
+  vector<int> flash_queue;
 
-  bool operator ==(const Point& rhs) const {
-    return x == rhs.x && y == rhs.y;
-  }
+  int stride() const { return width + 2; }
 
-  bool operator !=(const Point& rhs) const {
-    return !(*this == rhs);
+  int index(Point point) const {
+    return (point.y + 1) * stride() + point.x + 1;
   }
 
-  vector<Point> neighbors() {
-    return {
-      {x - 1, y - 1},
-      {x - 1, y + 0},
-      {x - 1, y + 1},
-      {x + 0, y - 1},
-      {x + 0, y + 1},
-      {x + 1, y - 1},
-      {x + 1, y + 0},
-      {x + 1, y + 1},
-    };
-  }
-};
+  int size() const { return width * height; }
 
-struct Grid {
-  map<Point, EnergyLevel> points;
-
-  void print() {
-    for (int y = 0; y < 5; ++y) {
-      for (int x = 0; x < 5; ++x) {
-        cout << raw_energy_level(points[{x, y}]);
+  void print() const {
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        cout << (int)cells[index({x, y})];
       }
       cout << endl;
     }
   }
 
+  // Increases every octopus in one sweep per row, which the compiler can
+  // vectorize, and queues the ones that flash as a result.
   void increase_all_points() {
-    map<Point, EnergyLevel> new_points;
-    for (auto i = points.begin(); i != points.end(); ++i)
-      new_points[i->first] = increase_energy_level(i->second);
-
-    points = new_points;
-  }
-
-  vector<Point> current_flash_points() {
-    vector<Point> current_flash_points;
-    for (auto i = points.begin(); i != points.end(); ++i)
-      if (i->second == zero)
-        current_flash_points.push_back(i->first);
-
-    return current_flash_points;
+    for (int y = 0; y < height; ++y) {
+      EnergyLevel* row = &cells[index({0, y})];
+      for (int x = 0; x < width; ++x) {
+        row[x]++;
+      }
+      for (int x = 0; x < width; ++x) {
+        if (row[x] == flashed)
+          flash_queue.push_back(index({x, y}));
+      }
+    }
   }
 
   int advance_step() {
+    flash_queue.clear();
     increase_all_points();
-    vector<Point> seen_flash_points = current_flash_points();
-
-    vector<Point> new_flash_points = seen_flash_points;
 
-    while (!new_flash_points.empty()) {
-      vector<Point> points_to_increase;
-      for (auto i = new_flash_points.begin(); i != new_flash_points.end(); ++i) {
-        vector<Point> neighbors = i->neighbors();
-        points_to_increase.insert(points_to_increase.begin(), neighbors.begin(), neighbors.end());
+    const int s = stride();
+    const int neighbor_offsets[] = {-s - 1, -s, -s + 1, -1, 1, s - 1, s, s + 1};
+    for (size_t i = 0; i < flash_queue.size(); ++i) {
+      int flash_index = flash_queue[i];
+      for (int offset : neighbor_offsets) {
+        EnergyLevel& neighbor = cells[flash_index + offset];
+        if (neighbor < flashed && ++neighbor == flashed)
+          flash_queue.push_back(flash_index + offset);
       }
+    }
 
-      new_flash_points.clear();
-
-      map<Point, EnergyLevel> new_points;
-      for (auto i = points.begin(); i != points.end(); ++i) {
-        Point point = i->first;
-        EnergyLevel new_energy_level = i->second;
-        for (auto p = points_to_increase.begin(); p != points_to_increase.end(); ++p) {
-          if (*p != point || count(seen_flash_points.begin(), seen_flash_points.end(), point) > 0) {
-            new_points[point] = i->second;
-            continue;
-          }
-
-          new_energy_level = increase_energy_level(new_energy_level);
+    for (auto i = flash_queue.begin(); i != flash_queue.end(); ++i) {
+      cells[*i] = 0;
+    }
+    return flash_queue.size();
+  }
 
-          if (new_energy_level == zero) {
-            seen_flash_points.push_back(point);
-            new_flash_points.push_back(point);
-          }
-        }
+  bool has_same_levels(const Grid& rhs) const {
+    return cells == rhs.cells;
+  }
+};
 
-        new_points[point] = new_energy_level;
-      }
+// Steps a grid forward until it repeats a state, so that flash counts for any
+// later step follow from the cycle without simulating it. Repeats are found
+// with Brent's algorithm, which compares the grid against a single saved
+// checkpoint that moves forward whenever the distance to it reaches a power
+// of two. Once the distance at which the grid first matches it gives the
+// period, the cycle's start is found by stepping two copies of the starting
+// grid a period apart until they agree. No states are kept besides those
+// copies.
+struct Simulation {
+  Grid grid;
+  Grid initial_grid;
+  Grid checkpoint;
+  uint64_t checkpoint_step = 0;
+  uint64_t checkpoint_span = 1;
+  // `total_flashes[n]` is the number of flashes in the first `n` steps.
+  vector<uint64_t> total_flashes = {0};
+  optional<uint64_t> first_synchronized_step;
+  optional<uint64_t> cycle_start;
+  uint64_t cycle_period = 0;
+
+  Simulation(Grid grid) : grid(grid), initial_grid(grid), checkpoint(grid) {}
+
+  uint64_t steps() const { return total_flashes.size() - 1; }
+
+  // The first step whose state comes round again `cycle_period` steps later.
+  uint64_t find_cycle_start() const {
+    Grid earlier = initial_grid;
+    Grid later = initial_grid;
+    for (uint64_t i = 0; i < cycle_period; ++i)
+      later.advance_step();
+    uint64_t start = 0;
+    while (!earlier.has_same_levels(later)) {
+      earlier.advance_step();
+      later.advance_step();
+      start++;
+    }
+    return start;
+  }
 
-      points = new_points;
+  // Advances one step, returning false once the grid has entered a cycle.
+  bool advance() {
+    if (cycle_start.has_value())
+      return false;
+
+    int flashes = grid.advance_step();
+    total_flashes.push_back(total_flashes.back() + flashes);
+    if (flashes == grid.size() && !first_synchronized_step.has_value())
+      first_synchronized_step = steps();
+
+    if (grid.has_same_levels(checkpoint)) {
+      cycle_period = steps() - checkpoint_step;
+      cycle_start = find_cycle_start();
+      initial_grid = checkpoint = Grid();
+      return false;
+    }
+    if (steps() - checkpoint_step == checkpoint_span) {
+      checkpoint = grid;
+      checkpoint_step = steps();
+      checkpoint_span *= 2;
     }
+    return true;
+  }
+
+  uint64_t flashes_after(uint64_t target_steps) {
+    while (steps() < target_steps && advance()) {}
+    if (target_steps <= steps())
+      return total_flashes[target_steps];
+
+    uint64_t start = *cycle_start;
+    uint64_t period = cycle_period;
+    uint64_t flashes_per_cycle = total_flashes[start + period] - total_flashes[start];
+    uint64_t cycles = (target_steps - start) / period;
+    uint64_t remainder = (target_steps - start) % period;
+    return total_flashes[start + remainder] + cycles * flashes_per_cycle;
+  }
 
-    return seen_flash_points.size();
+  // Returns nullopt if the grid cycles without ever synchronizing.
+  optional<uint64_t> find_first_synchronized_step() {
+    while (!first_synchronized_step.has_value() && advance()) {}
+    return first_synchronized_step;
   }
 };
 
-Grid grid_from_lines(vector<Line> lines) {
-  map<Point, EnergyLevel> points;
-  for (int y = 0; y < lines.size(); ++y) {
-    Line line = lines[y];
-    for (int x = 0; x < line.levels.size(); ++x) {
-      points[{x, y}] = line.levels[x];
+Grid grid_from_lines(const vector<Line>& lines) {
+  Grid grid = {lines.empty() ? 0 : (int)lines[0].levels.size(), (int)lines.size(), {}, {}};
+  grid.cells.assign((grid.width + 2) * (grid.height + 2), flashed);
+  for (int y = 0; y < grid.height; ++y) {
+    const Line& line = lines[y];
+    if ((int)line.levels.size() != grid.width)
+      abort();
+    for (int x = 0; x < grid.width; ++x) {
+      grid.cells[grid.index({x, y})] = line.levels[x];
     }
   }
-  return {points};
+  return grid;
 }
 
 // MARK: - Parsers
 
 EnergyLevel parse_energy_level(char input) {
-  switch (input) {
-  case '0':
-    return EnergyLevel::zero;
-  case '1':
-    return EnergyLevel::one;
-  case '2':
-    return EnergyLevel::two;
-  case '3':
-    return EnergyLevel::three;
-  case '4':
-    return EnergyLevel::four;
-  case '5':
-    return EnergyLevel::five;
-  case '6':
-    return EnergyLevel::six;
-  case '7':
-    return EnergyLevel::seven;
-  case '8':
-    return EnergyLevel::eight;
-  case '9':
-    return EnergyLevel::nine;
-  default:
+  if (input < '0' || input > '9')
     abort();
-  }
+  return input - '0';
 }
 
 Line parse_line(string input) {
@@ -216,23 +205,18 @@ Line parse_line(string input) {
 
 // MARK: - Parts 1 & 2
 
-int part1(Grid grid) {
-  int sum = 0;
-  for (int i = 0; i < 100; ++i) {
-    sum += grid.advance_step();
-  }
-  return sum;
+uint64_t part1(Simulation& simulation) {
+  return simulation.flashes_after(100);
 }
 
-int part2(Grid grid) {
-  for (int i = 1; i < 100000; ++i)
-    if (grid.advance_step() == 100)
-      return i;
-
-  abort();
+uint64_t part2(Simulation& simulation) {
+  optional<uint64_t> step = simulation.find_first_synchronized_step();
+  if (!step.has_value())
+    abort();
+  return *step;
 }
 
-int main() {
+int main(int argc, char** argv) {
   // MARK: - Read Input
 
   ifstream is("input.txt");
@@ -242,8 +226,18 @@ int main() {
     parsed_lines.push_back(parse_line(str));
   }
 
-  Grid grid = grid_from_lines(parsed_lines);
-  cout << "Part 1: " << part1(grid) << endl;
-  cout << "Part 2: " << part2(grid) << endl;
+  Simulation simulation(grid_from_lines(parsed_lines));
+
+  // Optionally answer flash counts for other step counts, however large.
+  if (argc > 1) {
+    for (int i = 1; i < argc; ++i) {
+      uint64_t steps = stoull(argv[i]);
+      cout << "Flashes after " << steps << " steps: " << simulation.flashes_after(steps) << endl;
+    }
+    return 0;
+  }
+
+  cout << "Part 1: " << part1(simulation) << endl;
+  cout << "Part 2: " << part2(simulation) << endl;
   return 0;
 }
@@ -3,31 +3,39 @@
 #include <cctype>
 #include <iterator>
 #include <iostream>
+#include <cstdint>
 #include <cstring>
-#include <map>
-#include <set>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 using namespace std;
 
 // MARK: - ID Factory
 
-uint8_t get_id_for_name(string name) {
-  static map<string, uint8_t> mapping({{"start", 0}, {"end", 1}});
-  static uint8_t next_id = 2;
-  if (mapping.count(name))
-    return mapping[name];
+// Assigns dense ids to cave names in the order they're first seen, with start
+// and end always 0 and 1.
+struct CaveInterner {
+  unordered_map<string, uint32_t> ids;
+  vector<string> names;
 
-  next_id++;
-  mapping[name] = next_id;
-  return next_id;
-}
+  CaveInterner() {
+    intern("start");
+    intern("end");
+  }
+
+  uint32_t intern(const string& name) {
+    auto inserted = ids.insert({name, (uint32_t)names.size()});
+    if (inserted.second)
+      names.push_back(name);
+    return inserted.first->second;
+  }
+};
 
 // MARK: - Models
 
 struct Cave {
-  uint8_t id;
+  uint32_t id;
   bool is_small;
 
   bool operator ==(const Cave& rhs) const {
@@ -54,109 +62,271 @@ struct Cave {
 struct Segment {
   Cave cave1;
   Cave cave2;
+};
 
-  bool contains(Cave cave) {
-    return cave == cave1 || cave == cave2;
-  }
+enum RevisitPolicy {
+  // Part 1: small caves are visited at most once.
+  no_revisits,
+  // Part 2: a single small cave other than start and end may be visited twice.
+  single_revisit,
+};
+
+struct CaveRange {
+  const uint32_t* first;
+  const uint32_t* last;
+
+  const uint32_t* begin() const { return first; }
+  const uint32_t* end() const { return last; }
+  size_t size() const { return last - first; }
+  uint32_t operator [](size_t i) const { return first[i]; }
+};
+
+// Adjacency in compressed sparse row form: the neighbors of cave `c` are
+// `neighbor_ids[neighbor_offsets[c]]` up to `neighbor_ids[neighbor_offsets[c + 1]]`.
+// Small caves are flagged in a bitset and also numbered densely, so a set
+// of visited small caves can be a bitmask.
+struct CaveGraph {
+  static constexpr uint32_t not_small = UINT32_MAX;
+
+  vector<uint32_t> neighbor_offsets;
+  vector<uint32_t> neighbor_ids;
+  vector<bool> small_caves;
+  vector<uint32_t> small_index;
+  uint32_t small_cave_count;
+  vector<string> names;
+
+  uint32_t cave_count() const { return small_caves.size(); }
 
-  Cave other(Cave cave) {
-    return cave == cave1 ? cave2 : cave1;
+  bool is_small(uint32_t cave) const { return small_caves[cave]; }
+
+  CaveRange neighbors(uint32_t cave) const {
+    const uint32_t* ids = neighbor_ids.data();
+    return {ids + neighbor_offsets[cave], ids + neighbor_offsets[cave + 1]};
   }
 };
 
-struct Path {
-  vector<Cave> caves;
+CaveGraph graph_from_segments(const vector<Segment>& segments, const CaveInterner& interner) {
+  const uint32_t cave_count = interner.names.size();
+  CaveGraph graph = {
+    vector<uint32_t>(cave_count + 1, 0),
+    vector<uint32_t>(segments.size() * 2),
+    vector<bool>(cave_count, false),
+    vector<uint32_t>(cave_count, CaveGraph::not_small),
+    0,
+    interner.names,
+  };
+
+  for (auto i = segments.begin(); i != segments.end(); ++i) {
+    // Two adjacent large caves would allow infinitely many paths.
+    if (!i->cave1.is_small && !i->cave2.is_small)
+      abort();
+
+    graph.neighbor_offsets[i->cave1.id + 1]++;
+    graph.neighbor_offsets[i->cave2.id + 1]++;
+    for (Cave cave : {i->cave1, i->cave2}) {
+      if (cave.is_small && !graph.small_caves[cave.id]) {
+        graph.small_caves[cave.id] = true;
+        graph.small_index[cave.id] = graph.small_cave_count++;
+      }
+    }
+  }
+  for (uint32_t cave = 0; cave < cave_count; ++cave) {
+    graph.neighbor_offsets[cave + 1] += graph.neighbor_offsets[cave];
+  }
 
-  bool operator ==(const Path& rhs) const {
-    return caves == rhs.caves;
+  vector<uint32_t> next_slot(graph.neighbor_offsets.begin(), graph.neighbor_offsets.end() - 1);
+  for (auto i = segments.begin(); i != segments.end(); ++i) {
+    graph.neighbor_ids[next_slot[i->cave1.id]++] = i->cave2.id;
+    graph.neighbor_ids[next_slot[i->cave2.id]++] = i->cave1.id;
   }
+  return graph;
+}
 
-  bool operator <(const Path& rhs) const {
-    return caves < rhs.caves;
+// A set of small caves, as bits indexed by `CaveGraph::small_index`. Graphs
+// with at most 64 small caves use a single word, and larger ones a
+// `WideCaveSet`, which only grows as high as its highest bit.
+bool contains(uint64_t set, uint32_t index) {
+  return set >> index & 1;
+}
+
+uint64_t with(uint64_t set, uint32_t index) {
+  return set | uint64_t(1) << index;
+}
+
+struct WideCaveSet {
+  vector<uint64_t> words;
+
+  bool operator ==(const WideCaveSet& rhs) const {
+    return words == rhs.words;
   }
+};
 
-  bool is_valid(bool part1) {
-    set<Cave> visited_caves;
-    bool did_visit_small_cave_twice = false;
-    for (auto i = caves.begin(); i != caves.end(); ++i) {
-      Cave cave = *i;
-      if (!cave.is_small) {
+struct WideCaveSetHash {
+  size_t operator ()(const WideCaveSet& set) const {
+    uint64_t hash = 0xcbf29ce484222325;
+    for (auto w = set.words.begin(); w != set.words.end(); ++w)
+      hash = (hash ^ *w) * 0x100000001b3;
+    return hash;
+  }
+};
+
+bool contains(const WideCaveSet& set, uint32_t index) {
+  return index / 64 < set.words.size() && contains(set.words[index / 64], index % 64);
+}
+
+WideCaveSet with(WideCaveSet set, uint32_t index) {
+  if (index / 64 >= set.words.size())
+    set.words.resize(index / 64 + 1, 0);
+  set.words[index / 64] = with(set.words[index / 64], index % 64);
+  return set;
+}
+
+// Counts paths from a cave to the end without storing any of them. The count
+// only depends on the current cave, which small caves were visited and
+// whether the revisit was used, so each such state is explored once.
+template <typename CaveSet, typename Hash = hash<CaveSet>>
+struct PathCounter {
+  const CaveGraph& graph;
+  RevisitPolicy policy;
+  // One memo per (cave, revisit used) pair, keyed by visited small caves.
+  vector<unordered_map<CaveSet, uint64_t, Hash>> memo;
+
+  PathCounter(const CaveGraph& graph, RevisitPolicy policy)
+    : graph(graph), policy(policy), memo(graph.cave_count() * 2) {}
+
+  uint64_t count_from(uint32_t cave, const CaveSet& visited, bool revisit_used) {
+    if (cave == Cave::end().id)
+      return 1;
+
+    unordered_map<CaveSet, uint64_t, Hash>& cave_memo = memo[cave * 2 + revisit_used];
+    auto cached = cave_memo.find(visited);
+    if (cached != cave_memo.end())
+      return cached->second;
+
+    uint64_t result = 0;
+    for (uint32_t next : graph.neighbors(cave)) {
+      if (next == Cave::start().id) {
         continue;
-      } else if (count(visited_caves.begin(), visited_caves.end(), cave) == 0) {
-        visited_caves.insert(cave);
-      } else if (part1) {
-        return false;
-      } else if (did_visit_small_cave_twice) {
-        return false;
-      } else if (cave == Cave::start() || cave == Cave::end()) {
-        return false;
-      } else {
-        did_visit_small_cave_twice = true;
+      } else if (!graph.is_small(next)) {
+        result += count_from(next, visited, revisit_used);
+      } else if (!contains(visited, graph.small_index[next])) {
+        result += count_from(next, with(visited, graph.small_index[next]), revisit_used);
+      } else if (policy == single_revisit && !revisit_used) {
+        result += count_from(next, visited, true);
       }
     }
 
-    return true;
+    cave_memo[visited] = result;
+    return result;
   }
 
-  bool reaches_end() const {
-    return caves[caves.size() - 1] == Cave::end();
+  uint64_t count() {
+    uint32_t start = Cave::start().id;
+    return count_from(start, with(CaveSet(), graph.small_index[start]), false);
   }
 };
 
-struct Map {
-  vector<Segment> segments;
-
-  vector<Cave> caves_accessible(Cave cave) {
-    vector<Cave> result;
-    for (auto i = segments.begin(); i != segments.end(); ++i)
-      if (i->contains(cave))
-        result.push_back(i->other(cave));
+uint64_t count_paths(const CaveGraph& graph, RevisitPolicy policy) {
+  if (graph.small_cave_count <= 64)
+    return PathCounter<uint64_t>(graph, policy).count();
+  return PathCounter<WideCaveSet, WideCaveSetHash>(graph, policy).count();
+}
 
-    return result;
+// Yields every valid path from start to end, one at a time, by backtracking
+// over a single path buffer. Memory stays proportional to the longest path
+// however many paths there are.
+//
+//     PathEnumerator paths(graph, single_revisit);
+//     while (paths.next())
+//       use(paths.path());
+class PathEnumerator {
+public:
+  PathEnumerator(const CaveGraph& graph, RevisitPolicy policy)
+    : graph(graph), policy(policy), visited(graph.cave_count(), false) {
+    push(Cave::start().id, false);
   }
 
-  int complete_paths(bool part1) {
-    vector<Cave> start_accessibles = caves_accessible(Cave::start());
-    vector<Path> possible_paths;
-    for (auto i = start_accessibles.begin(); i != start_accessibles.end(); ++i)
-      possible_paths.push_back({{Cave::start(), *i}});
-
-    set<Path> complete_paths;
-    while (!possible_paths.empty()) {
-      set<Path> new_possible_paths;
-      for (auto i = possible_paths.begin(); i != possible_paths.end(); ++i) {
-        vector<Path> more = generate_more(*i, part1);
-        for (auto m = more.begin(); m != more.end(); ++m)
-          if (count(complete_paths.begin(), complete_paths.end(), *m) == 0)
-            new_possible_paths.insert(*m);
+  // Advances to the next path, returning false once all have been yielded.
+  bool next() {
+    if (!frames.empty() && frames.back().cave == Cave::end().id)
+      pop();
+
+    while (!frames.empty()) {
+      Frame& top = frames.back();
+      CaveRange neighbors = graph.neighbors(top.cave);
+      if (top.next_neighbor == neighbors.size()) {
+        pop();
+        continue;
       }
 
-      possible_paths.clear();
-      for (auto i = new_possible_paths.begin(); i != new_possible_paths.end(); ++i) {
-        if (i->reaches_end()) {
-          complete_paths.insert(*i);
-        } else {
-          possible_paths.push_back(*i);
-        }
+      uint32_t next = neighbors[top.next_neighbor++];
+      if (next == Cave::start().id) {
+        continue;
+      } else if (!graph.is_small(next) || !visited[next]) {
+        push(next, false);
+      } else if (policy == single_revisit && !revisit_used) {
+        push(next, true);
+      } else {
+        continue;
       }
+
+      if (next == Cave::end().id)
+        return true;
     }
+    return false;
+  }
 
-    return complete_paths.size();
+  // The caves of the current path, from start to end.
+  const vector<uint32_t>& path() const { return caves; }
+
+private:
+  struct Frame {
+    uint32_t cave;
+    size_t next_neighbor;
+    bool is_revisit;
+  };
+
+  const CaveGraph& graph;
+  RevisitPolicy policy;
+  vector<Frame> frames;
+  vector<bool> visited;
+  vector<uint32_t> caves;
+  bool revisit_used = false;
+
+  void push(uint32_t cave, bool is_revisit) {
+    frames.push_back({cave, 0, is_revisit});
+    caves.push_back(cave);
+    if (is_revisit) {
+      revisit_used = true;
+    } else if (graph.is_small(cave)) {
+      visited[cave] = true;
+    }
   }
 
-  vector<Path> generate_more(Path path, bool part1) {
-    vector<Cave> accessibles = caves_accessible(path.caves[path.caves.size() - 1]);
-    vector<Path> result;
-    for (auto i = accessibles.begin(); i != accessibles.end(); ++i) {
-      Path new_path = path;
-      new_path.caves.push_back(*i);
-      if (new_path.is_valid(part1))
-        result.push_back(new_path);
+  void pop() {
+    Frame frame = frames.back();
+    frames.pop_back();
+    caves.pop_back();
+    if (frame.is_revisit) {
+      revisit_used = false;
+    } else if (graph.is_small(frame.cave)) {
+      visited[frame.cave] = false;
     }
-    return result;
   }
 };
 
+// Writes every path allowed by `policy`, one per line, with caves named and
+// separated by commas.
+void print_paths(const CaveGraph& graph, RevisitPolicy policy, ostream& os) {
+  PathEnumerator paths(graph, policy);
+  while (paths.next()) {
+    const vector<uint32_t>& caves = paths.path();
+    for (size_t i = 0; i < caves.size(); ++i)
+      os << (i > 0 ? "," : "") << graph.names[caves[i]];
+    os << '\n';
+  }
+}
+
 // MARK: - Parsers
 
 vector<string> split(string str, string token){
@@ -175,35 +345,46 @@ vector<string> split(string str, string token){
   return result;
 }
 
-Segment parse_segment(string input) {
+Segment parse_segment(string input, CaveInterner& interner) {
   vector<string> segment_strings = split(input, "-");
-  Cave cave1 = {get_id_for_name(segment_strings[0]), islower(segment_strings[0][0]) > 0};
-  Cave cave2 = {get_id_for_name(segment_strings[1]), islower(segment_strings[1][0]) > 0};
+  Cave cave1 = {interner.intern(segment_strings[0]), islower(segment_strings[0][0]) > 0};
+  Cave cave2 = {interner.intern(segment_strings[1]), islower(segment_strings[1][0]) > 0};
   return {cave1, cave2};
 }
 
 // MARK: - Parts 1 & 2
 
-int part1(Map map) {
-  return map.complete_paths(true);
+uint64_t part1(const CaveGraph& graph) {
+  return count_paths(graph, no_revisits);
 }
 
-int part2(Map map) {
-  return map.complete_paths(false);
+uint64_t part2(const CaveGraph& graph) {
+  return count_paths(graph, single_revisit);
 }
 
-int main() {
+int main(int argc, char** argv) {
   // MARK: - Read Input
 
   ifstream is("input.txt");
   string str;
+  CaveInterner interner;
   vector<Segment> parsed_segments;
   while(getline(is, str)) {
-    parsed_segments.push_back(parse_segment(str));
+    parsed_segments.push_back(parse_segment(str, interner));
+  }
+
+  CaveGraph graph = graph_from_segments(parsed_segments, interner);
+
+  // Lists one part's paths instead of counting them.
+  if (argc > 2 && string(argv[1]) == "--paths") {
+    string part = argv[2];
+    if (part != "1" && part != "2")
+      abort();
+    print_paths(graph, part == "1" ? no_revisits : single_revisit, cout);
+    return 0;
   }
 
-  Map map = {parsed_segments};
-  cout << "Part 1: " << part1(map) << endl;
-  cout << "Part 2: " << part2(map) << endl;
+  cout << "Part 1: " << part1(graph) << endl;
+  cout << "Part 2: " << part2(graph) << endl;
   return 0;
 }
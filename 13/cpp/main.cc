@@ -5,7 +5,8 @@
 #include <iostream>
 #include <cstring>
 #include <map>
-#include <set>
+#include <numeric>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -46,53 +47,178 @@ struct Dot {
   }
 };
 
-struct Grid {
-  vector<Dot> dots;
-  int max_x;
-  int max_y;
+// Where every coordinate along one axis ends up after a sequence of folds.
+// Folds compose, so the table is built once from the instructions and each
+// dot is then mapped with a single lookup per axis.
+struct FoldTable {
+  static constexpr int off_sheet = -1;
+
+  vector<int> positions;
+  // The extent of the sheet along this axis once every fold is applied.
+  int size;
+
+  static FoldTable identity(int max_value) {
+    FoldTable table = {vector<int>(max_value + 1), max_value + 1};
+    iota(table.positions.begin(), table.positions.end(), 0);
+    return table;
+  }
 
-  string description() {
-    string description;
-    for (int y = 0; y <= max_y; ++y) {
-      for (int x = 0; x <= max_x; ++x) {
-        Dot dot({x, y});
-        bool has_dot = count(dots.begin(), dots.end(), dot) > 0;
-        description += has_dot ? "#" : ".";
+  // Reflects everything past `value` back over it. Dots never land on a fold
+  // line, so coordinates that do, or that reflect past the edge, drop off and
+  // stay off through later folds.
+  void fold(int value) {
+    for (auto i = positions.begin(); i != positions.end(); ++i) {
+      if (*i > value) {
+        *i = 2 * value - *i >= 0 ? 2 * value - *i : off_sheet;
+      } else if (*i == value) {
+        *i = off_sheet;
       }
-      description += "\n";
     }
-    return description;
+    size = min(size, value);
+  }
+
+  int operator [](int value) const { return positions[value]; }
+};
+
+// A packed bitmap of the dots on the sheet, one row of 64-bit words per line.
+struct Sheet {
+  int width;
+  int height;
+  int words_per_row;
+  vector<uint64_t> bits;
+
+  Sheet(int width, int height)
+    : width(width), height(height), words_per_row((width + 63) / 64),
+      bits(words_per_row * height, 0) {}
+
+  void insert(int x, int y) {
+    bits[y * words_per_row + x / 64] |= uint64_t(1) << (x % 64);
   }
 
-  Grid folding(Instruction instruction) {
-    vector<Dot> new_dots = dots;
-    int new_max_x = max_x;
-    int new_max_y = max_y;
-    int value = instruction.value;
-    switch (instruction.type) {
-    case fold_up:
-      new_max_y = value - 1;
-      for (int y = value + 1; y <= max_y; ++y) {
-        int new_y = value - (y - value);
-        for (int i = 0; i < new_dots.size(); ++i)
-          if (new_dots[i].y == y)
-            new_dots[i] = {new_dots[i].x, new_y};
+  bool contains(int x, int y) const {
+    return (bits[y * words_per_row + x / 64] >> (x % 64)) & 1;
+  }
+
+  int dot_count() const {
+    int result = 0;
+    for (auto i = bits.begin(); i != bits.end(); ++i) {
+      result += __builtin_popcountll(*i);
+    }
+    return result;
+  }
+
+  string description() const {
+    const int line_length = width + 1;
+    string description(line_length * height, '.');
+    for (int y = 0; y < height; ++y) {
+      char* line = &description[y * line_length];
+      const uint64_t* row = &bits[y * words_per_row];
+      for (int x = 0; x < width; ++x) {
+        if ((row[x / 64] >> (x % 64)) & 1)
+          line[x] = '#';
       }
-      break;
-    case fold_left:
-      new_max_x = value - 1;
-      for (int x = value + 1; x <= max_x; ++x) {
-        int new_x = value - (x - value);
-        for (int i = 0; i < new_dots.size(); ++i)
-          if (new_dots[i].x == x)
-            new_dots[i] = {new_x, new_dots[i].y};
+      line[width] = '\n';
+    }
+    return description;
+  }
+};
+
+// MARK: - Letter Recognition
+
+const int glyph_width = 4;
+const int glyph_height = 6;
+// Letters are separated by one blank column.
+const int glyph_stride = glyph_width + 1;
+
+// The capital letters the puzzles draw, row by row.
+const vector<pair<char, string>> glyph_patterns = {
+  {'A', ".##." "#..#" "#..#" "####" "#..#" "#..#"},
+  {'B', "###." "#..#" "###." "#..#" "#..#" "###."},
+  {'C', ".##." "#..#" "#..." "#..." "#..#" ".##."},
+  {'E', "####" "#..." "###." "#..." "#..." "####"},
+  {'F', "####" "#..." "###." "#..." "#..." "#..."},
+  {'G', ".##." "#..#" "#..." "#.##" "#..#" ".###"},
+  {'H', "#..#" "#..#" "####" "#..#" "#..#" "#..#"},
+  {'I', ".###" "..#." "..#." "..#." "..#." ".###"},
+  {'J', "..##" "...#" "...#" "...#" "#..#" ".##."},
+  {'K', "#..#" "#.#." "##.." "#.#." "#.#." "#..#"},
+  {'L', "#..." "#..." "#..." "#..." "#..." "####"},
+  {'O', ".##." "#..#" "#..#" "#..#" "#..#" ".##."},
+  {'P', "###." "#..#" "#..#" "###." "#..." "#..."},
+  {'R', "###." "#..#" "#..#" "###." "#.#." "#..#"},
+  {'S', ".###" "#..." "#..." ".##." "...#" "###."},
+  {'U', "#..#" "#..#" "#..#" "#..#" "#..#" ".##."},
+  {'Z', "####" "...#" "..#." ".#.." "#..." "####"},
+};
+
+// Packs a glyph into 24 bits, the top-left pixel in the highest bit.
+uint32_t glyph_bits(const string& pattern) {
+  uint32_t result = 0;
+  for (auto i = pattern.begin(); i != pattern.end(); ++i) {
+    result = (result << 1) | (*i == '#');
+  }
+  return result;
+}
+
+uint32_t glyph_bits(const Sheet& sheet, int left) {
+  uint32_t result = 0;
+  for (int y = 0; y < glyph_height; ++y) {
+    for (int x = left; x < left + glyph_width; ++x) {
+      result = (result << 1) | (x < sheet.width && sheet.contains(x, y));
+    }
+  }
+  return result;
+}
+
+// Reads the letters drawn on a sheet, or returns nullopt if the sheet isn't
+// one row of letters. Shapes that aren't known letters are read as `?`.
+optional<string> recognize_letters(const Sheet& sheet) {
+  static const map<uint32_t, char> letters_by_glyph = [] {
+    map<uint32_t, char> result;
+    for (auto i = glyph_patterns.begin(); i != glyph_patterns.end(); ++i) {
+      result[glyph_bits(i->second)] = i->first;
+    }
+    return result;
+  }();
+
+  if (sheet.height != glyph_height)
+    return nullopt;
+
+  string result;
+  for (int left = 0; left < sheet.width; left += glyph_stride) {
+    auto letter = letters_by_glyph.find(glyph_bits(sheet, left));
+    result += letter == letters_by_glyph.end() ? '?' : letter->second;
+  }
+  return result;
+}
+
+struct Grid {
+  vector<Dot> dots;
+  int max_x;
+  int max_y;
+
+  Sheet folding(vector<Instruction>::const_iterator begin, vector<Instruction>::const_iterator end) const {
+    FoldTable x_table = FoldTable::identity(max_x);
+    FoldTable y_table = FoldTable::identity(max_y);
+    for (auto i = begin; i != end; ++i) {
+      switch (i->type) {
+      case fold_up:
+        y_table.fold(i->value);
+        break;
+      case fold_left:
+        x_table.fold(i->value);
+        break;
       }
-      break;
     }
 
-    set<Dot> new_dots_set(new_dots.begin(), new_dots.end());
-    vector<Dot> new_dots_unique(new_dots_set.begin(), new_dots_set.end());
-    return {new_dots_unique, new_max_x, new_max_y};
+    Sheet sheet(x_table.size, y_table.size);
+    for (auto dot = dots.begin(); dot != dots.end(); ++dot) {
+      int x = x_table[dot->x];
+      int y = y_table[dot->y];
+      if (x != FoldTable::off_sheet && y != FoldTable::off_sheet)
+        sheet.insert(x, y);
+    }
+    return sheet;
   }
 };
 
@@ -138,18 +264,15 @@ Line parse_line(string input) {
 
 // MARK: - Parts 1 & 2
 
-int part1(Grid grid, vector<Instruction> instructions) {
-  return grid.folding(instructions[0]).dots.size();
+int part1(const Grid& grid, const vector<Instruction>& instructions) {
+  return grid.folding(instructions.begin(), instructions.begin() + 1).dot_count();
 }
 
-string part2(Grid grid, vector<Instruction> instructions) {
-  for (auto i = instructions.begin(); i != instructions.end(); ++i) {
-    grid = grid.folding(*i);
-  }
-  return grid.description();
+Sheet part2(const Grid& grid, const vector<Instruction>& instructions) {
+  return grid.folding(instructions.begin(), instructions.end());
 }
 
-int main() {
+int main(int argc, char** argv) {
   // MARK: - Read Input
 
   ifstream is("input.txt");
@@ -179,6 +302,17 @@ int main() {
 
   Grid grid = {dots, max_x, max_y};
   cout << "Part 1: " << part1(grid, instructions) << endl;
-  cout << "Part 2:" << endl << part2(grid, instructions);
+  Sheet sheet = part2(grid, instructions);
+
+  // Print the letters as text rather than as a drawing.
+  if (argc > 1 && string(argv[1]) == "--ocr") {
+    optional<string> letters = recognize_letters(sheet);
+    if (!letters.has_value())
+      abort();
+    cout << "Part 2: " << *letters << endl;
+    return 0;
+  }
+
+  cout << "Part 2:" << endl << sheet.description();
   return 0;
 }
@@ -1,425 +1,342 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <fstream>
 #include <iostream>
-#include <map>
+#include <optional>
 #include <string>
 #include <vector>
+#include "../../shared/cpp/big_uint.h"
 using namespace std;
 
-// MARK: - BigInt
+// MARK: - Wide Integers
 
-// From: https://www.geeksforgeeks.org/bigint-big-integers-in-c-with-example/
+typedef BigUint Count;
 
-class BigInt {
-    string digits;
-public:
+// Counts modulo a prime, for step counts whose exact counts are too large to
+// store.
+struct ModularCount {
+  static constexpr uint64_t modulus = 1000000007;
 
-    //Constructors:
-    BigInt(unsigned long long n = 0);
-    BigInt(string &);
-    BigInt(const char *);
-    BigInt(const BigInt&);
+  uint64_t value;
 
-    //Helper Functions:
-    friend bool Null(const BigInt &);
-    friend int Lenght(const BigInt &);
-    int operator[](const int)const;
+  ModularCount(uint64_t value = 0) : value(value % modulus) {}
 
-               /* * * * Operator Overloading * * * */
-
-    //Direct assignment
-    BigInt &operator=(const BigInt &);
-
-    //Post/Pre - Incrementation
-    BigInt &operator++();
-    BigInt operator++(int temp);
-    BigInt &operator--();
-    BigInt operator--(int temp);
-
-    //Addition and Subtraction
-    friend BigInt &operator+=(BigInt &, const BigInt &);
-    friend BigInt operator+(const BigInt &, const BigInt &);
-    friend BigInt operator-(const BigInt &, const BigInt &);
-    friend BigInt &operator-=(BigInt &, const BigInt &);
-
-    //Comparison operators
-    friend bool operator==(const BigInt &, const BigInt &);
-    friend bool operator!=(const BigInt &, const BigInt &);
-
-    friend bool operator>(const BigInt &, const BigInt &);
-    friend bool operator>=(const BigInt &, const BigInt &);
-    friend bool operator<(const BigInt &, const BigInt &);
-    friend bool operator<=(const BigInt &, const BigInt &);
-
-    //Multiplication and Division
-    friend BigInt &operator*=(BigInt &, const BigInt &);
-    friend BigInt operator*(const BigInt &, const BigInt &);
-    friend BigInt &operator/=(BigInt &, const BigInt &);
-    friend BigInt operator/(const BigInt &, const BigInt &);
-
-    //Read and Write
-    friend ostream &operator<<(ostream &,const BigInt &);
+  ModularCount operator +(ModularCount rhs) const { return ModularCount(value + rhs.value); }
+  ModularCount operator *(ModularCount rhs) const { return ModularCount(value * rhs.value); }
 };
 
-BigInt::BigInt(string & s){
-    digits = "";
-    int n = s.size();
-    for (int i = n - 1; i >= 0;i--){
-        if(!isdigit(s[i]))
-            throw("ERROR");
-        digits.push_back(s[i] - '0');
-    }
-}
-BigInt::BigInt(unsigned long long nr){
-    do{
-        digits.push_back(nr % 10);
-        nr /= 10;
-    } while (nr);
-}
-BigInt::BigInt(const char *s){
-    digits = "";
-    for (int i = strlen(s) - 1; i >= 0;i--)
-    {
-        if(!isdigit(s[i]))
-            throw("ERROR");
-        digits.push_back(s[i] - '0');
-    }
-}
-BigInt::BigInt(const BigInt& a){
-    digits = a.digits;
-}
-
-bool Null(const BigInt& a){
-    if(a.digits.size() == 1 && a.digits[0] == 0)
-        return true;
-    return false;
-}
-int Lenght(const BigInt & a){
-    return a.digits.size();
-}
-int BigInt::operator[](const int index)const{
-    if(digits.size() <= index || index < 0)
-        throw("ERROR");
-    return digits[index];
-}
-bool operator==(const BigInt &a, const BigInt &b){
-    return a.digits == b.digits;
-}
-bool operator!=(const BigInt & a,const BigInt &b){
-    return !(a == b);
-}
-bool operator<(const BigInt&a,const BigInt&b){
-    int n = Lenght(a), m = Lenght(b);
-    if(n != m)
-        return n < m;
-    while(n--)
-        if(a.digits[n] != b.digits[n])
-            return a.digits[n] < b.digits[n];
-    return false;
-}
-bool operator>(const BigInt&a,const BigInt&b){
-    return b < a;
-}
-bool operator>=(const BigInt&a,const BigInt&b){
-    return !(a < b);
-}
-bool operator<=(const BigInt&a,const BigInt&b){
-    return !(a > b);
-}
-
-BigInt &BigInt::operator=(const BigInt &a){
-    digits = a.digits;
-    return *this;
-}
-
-BigInt &BigInt::operator++(){
-    int i, n = digits.size();
-    for (i = 0; i < n && digits[i] == 9;i++)
-        digits[i] = 0;
-    if(i == n)
-        digits.push_back(1);
-    else
-        digits[i]++;
-    return *this;
-}
-BigInt BigInt::operator++(int temp){
-    BigInt aux;
-    aux = *this;
-    ++(*this);
-    return aux;
-}
+// An approximate count with an unbounded exponent, `mantissa * 2^exponent`.
+// It can't give exact answers but can tell which elements are most and least
+// common at any step count.
+struct ScaledCount {
+  double mantissa;
+  int64_t exponent;
+
+  ScaledCount() : mantissa(0), exponent(0) {}
+  ScaledCount(uint64_t value) : ScaledCount(normalized(value, 0)) {}
+
+  static ScaledCount normalized(double mantissa, int64_t exponent) {
+    ScaledCount result;
+    int shift = 0;
+    result.mantissa = frexp(mantissa, &shift);
+    result.exponent = mantissa == 0 ? 0 : exponent + shift;
+    return result;
+  }
 
-BigInt &BigInt::operator--(){
-    if(digits[0] == 0 && digits.size() == 1)
-        throw("UNDERFLOW");
-    int i, n = digits.size();
-    for (i = 0; digits[i] == 0 && i < n;i++)
-        digits[i] = 9;
-    digits[i]--;
-    if(n > 1 && digits[n - 1] == 0)
-        digits.pop_back();
-    return *this;
-}
-BigInt BigInt::operator--(int temp){
-    BigInt aux;
-    aux = *this;
-    --(*this);
-    return aux;
-}
+  ScaledCount operator +(ScaledCount rhs) const {
+    if (rhs.mantissa == 0)
+      return *this;
+    if (mantissa == 0)
+      return rhs;
+    const ScaledCount& larger = exponent >= rhs.exponent ? *this : rhs;
+    const ScaledCount& smaller = exponent >= rhs.exponent ? rhs : *this;
+    return normalized(larger.mantissa + ldexp(smaller.mantissa, -(int)min<int64_t>(larger.exponent - smaller.exponent, 1024)), larger.exponent);
+  }
 
-BigInt &operator+=(BigInt &a,const BigInt& b){
-    int t = 0, s, i;
-    int n = Lenght(a), m = Lenght(b);
-    if(m > n)
-        a.digits.append(m - n, 0);
-    n = Lenght(a);
-    for (i = 0; i < n;i++){
-        if(i < m)
-            s = (a.digits[i] + b.digits[i]) + t;
-        else
-            s = a.digits[i] + t;
-        t = s / 10;
-        a.digits[i] = (s % 10);
-    }
-    if(t)
-        a.digits.push_back(t);
-    return a;
-}
-BigInt operator+(const BigInt &a, const BigInt &b){
-    BigInt temp;
-    temp = a;
-    temp += b;
-    return temp;
-}
+  ScaledCount operator *(ScaledCount rhs) const {
+    return normalized(mantissa * rhs.mantissa, exponent + rhs.exponent);
+  }
 
-BigInt &operator-=(BigInt&a,const BigInt &b){
-    if(a < b)
-        throw("UNDERFLOW");
-    int n = Lenght(a), m = Lenght(b);
-    int i, t = 0, s;
-    for (i = 0; i < n;i++){
-        if(i < m)
-            s = a.digits[i] - b.digits[i]+ t;
-        else
-            s = a.digits[i]+ t;
-        if(s < 0)
-            s += 10,
-            t = -1;
-        else
-            t = 0;
-        a.digits[i] = s;
-    }
-    while(n > 1 && a.digits[n - 1] == 0)
-        a.digits.pop_back(),
-        n--;
-    return a;
-}
-BigInt operator-(const BigInt& a,const BigInt&b){
-    BigInt temp;
-    temp = a;
-    temp -= b;
-    return temp;
-}
+  bool operator <(ScaledCount rhs) const {
+    if (mantissa == 0 || rhs.mantissa == 0)
+      return rhs.mantissa != 0;
+    return exponent < rhs.exponent || (exponent == rhs.exponent && mantissa < rhs.mantissa);
+  }
+  // Whether the two differ by at most `tolerance` times the larger.
+  bool is_close_to(ScaledCount rhs, double tolerance) const {
+    if (mantissa == 0 || rhs.mantissa == 0)
+      return mantissa == rhs.mantissa;
+    if (abs(exponent - rhs.exponent) > 1)
+      return false;
+    double lhs_value = ldexp(mantissa, (int)(exponent - rhs.exponent));
+    return abs(lhs_value - rhs.mantissa) <= tolerance * max(lhs_value, rhs.mantissa);
+  }
+};
 
-BigInt &operator*=(BigInt &a, const BigInt &b)
-{
-    if(Null(a) || Null(b)){
-        a = BigInt();
-        return a;
-    }
-    int n = a.digits.size(), m = b.digits.size();
-    vector<int> v(n + m, 0);
-    for (int i = 0; i < n;i++)
-        for (int j = 0; j < m;j++){
-            v[i + j] += (a.digits[i] ) * (b.digits[j]);
-        }
-    n += m;
-    a.digits.resize(v.size());
-    for (int s, i = 0, t = 0; i < n; i++)
-    {
-        s = t + v[i];
-        v[i] = s % 10;
-        t = s / 10;
-        a.digits[i] = v[i] ;
-    }
-    for (int i = n - 1; i >= 1 && !v[i];i--)
-            a.digits.pop_back();
-    return a;
-}
-BigInt operator*(const BigInt&a,const BigInt&b){
-    BigInt temp;
-    temp = a;
-    temp *= b;
-    return temp;
-}
+// MARK: - Models
 
-BigInt &operator/=(BigInt& a,const BigInt &b){
-    if(Null(b))
-        throw("Arithmetic Error: Division By 0");
-    if(a < b){
-        a = BigInt();
-        return a;
-    }
-    if(a == b){
-        a = BigInt(1);
-        return a;
-    }
-    int i, lgcat = 0, cc;
-    int n = Lenght(a), m = Lenght(b);
-    vector<int> cat(n, 0);
-    BigInt t;
-    for (i = n - 1; t * 10 + a.digits[i]  < b;i--){
-        t *= 10;
-        t += a.digits[i] ;
-    }
-    for (; i >= 0; i--){
-        t = t * 10 + a.digits[i];
-        for (cc = 9; cc * b > t;cc--);
-        t -= cc * b;
-        cat[lgcat++] = cc;
-    }
-    a.digits.resize(cat.size());
-    for (i = 0; i < lgcat;i++)
-        a.digits[i] = cat[lgcat - i - 1];
-    a.digits.resize(lgcat);
-    return a;
-}
+const int alphabet_size = 26;
+const int pair_count = alphabet_size * alphabet_size;
 
-BigInt operator/(const BigInt &a,const BigInt &b){
-    BigInt temp;
-    temp = a;
-    temp /= b;
-    return temp;
+int element_index(char element) {
+  if (element < 'A' || element > 'Z')
+    abort();
+  return element - 'A';
 }
 
-ostream &operator<<(ostream &out,const BigInt &a){
-    for (int i = a.digits.size() - 1; i >= 0;i--)
-        cout << (short)a.digits[i];
-    return cout;
+int pair_index(int first, int second) {
+  return first * alphabet_size + second;
 }
 
-// MARK: - Models
-
 struct CharacterPair {
   char first;
   char second;
+};
 
-  bool operator ==(const CharacterPair& rhs) const {
-    return first == rhs.first
-      && second == rhs.second;
-  }
+struct Rule {
+  CharacterPair input;
+  char output;
+};
 
-  bool operator <(const CharacterPair& rhs) const {
-    return first < rhs.first ||
-      (first == rhs.first && second < rhs.second);
+// The element inserted between each pair, indexed by `pair_index`.
+struct Rules {
+  static constexpr int no_insertion = -1;
+
+  array<int, pair_count> insertions;
+
+  Rules(const vector<Rule>& vec) {
+    insertions.fill(no_insertion);
+    for (auto r = vec.begin(); r != vec.end(); ++r) {
+      int pair = pair_index(element_index(r->input.first), element_index(r->input.second));
+      insertions[pair] = element_index(r->output);
+    }
   }
 };
 
-struct TemplatePair {
-  CharacterPair characters;
-  bool at_start;
-  bool at_end;
+// How many times each pair of adjacent elements appears. Every element but
+// the last starts exactly one pair, and insertions never change the last
+// element, so it's tracked once to count elements from pairs.
+struct Template {
+  array<Count, pair_count> pairs;
+  int last_element;
+
+  void advance(const Rules& rules) {
+    array<Count, pair_count> new_pairs = {};
+    for (int pair = 0; pair < pair_count; ++pair) {
+      const Count& count = pairs[pair];
+      if (count.is_zero())
+        continue;
+
+      int insertion = rules.insertions[pair];
+      if (insertion == Rules::no_insertion) {
+        new_pairs[pair] += count;
+        continue;
+      }
 
-  bool on_edge() {
-    return at_start || at_end;
+      new_pairs[pair_index(pair / alphabet_size, insertion)] += count;
+      new_pairs[pair_index(insertion, pair % alphabet_size)] += count;
+    }
+    pairs = std::move(new_pairs);
   }
 
-  bool operator ==(const TemplatePair& rhs) const {
-    return characters == rhs.characters
-      && at_start == rhs.at_start
-      && at_end == rhs.at_end;
+  array<Count, alphabet_size> element_counts() const {
+    array<Count, alphabet_size> counts = {};
+    for (int pair = 0; pair < pair_count; ++pair) {
+      counts[pair / alphabet_size] += pairs[pair];
+    }
+    counts[last_element] += 1;
+    return counts;
   }
 
-  bool operator <(const TemplatePair& rhs) const {
-    return characters < rhs.characters ||
-      (characters == rhs.characters && at_start < rhs.at_start) ||
-      (characters == rhs.characters && at_start == rhs.at_start && at_end < rhs.at_end);
+  Count score() const {
+    array<Count, alphabet_size> counts = element_counts();
+    const Count* max_value = nullptr;
+    const Count* min_value = nullptr;
+    for (auto i = counts.begin(); i != counts.end(); ++i) {
+      if (i->is_zero())
+        continue;
+      if (max_value == nullptr || *max_value < *i)
+        max_value = &*i;
+      if (min_value == nullptr || *i < *min_value)
+        min_value = &*i;
+    }
+    return *max_value - *min_value;
   }
 };
 
-struct Rule {
-  CharacterPair input;
-  char output;
-};
+// MARK: - Matrix Exponentiation
 
-struct Rules {
-  map<CharacterPair, char> rules;
+template <typename T>
+struct Matrix {
+  size_t size;
+  vector<T> entries;
 
-  Rules(const vector<Rule>& vec) {
-    for (auto r = vec.begin(); r != vec.end(); ++r)
-      rules[r->input] = r->output;
+  Matrix(size_t size) : size(size), entries(size * size, T(0)) {}
+
+  T& at(size_t row, size_t column) { return entries[row * size + column]; }
+  const T& at(size_t row, size_t column) const { return entries[row * size + column]; }
+
+  Matrix operator *(const Matrix& rhs) const {
+    Matrix result(size);
+    for (size_t row = 0; row < size; ++row) {
+      for (size_t k = 0; k < size; ++k) {
+        const T& lhs_entry = at(row, k);
+        for (size_t column = 0; column < size; ++column) {
+          result.at(row, column) = result.at(row, column) + lhs_entry * rhs.at(k, column);
+        }
+      }
+    }
+    return result;
   }
 
-  optional<char> output(CharacterPair pair) {
-    if (rules.count(pair))
-      return rules[pair];
-    return nullopt;
+  vector<T> operator *(const vector<T>& vector) const {
+    std::vector<T> result(size, T(0));
+    for (size_t row = 0; row < size; ++row) {
+      for (size_t column = 0; column < size; ++column) {
+        result[row] = result[row] + at(row, column) * vector[column];
+      }
+    }
+    return result;
   }
 };
 
-struct Template {
-  map<TemplatePair, BigInt> pairs;
-
-  void advance(Rules rules) {
-    map<TemplatePair, BigInt> new_pairs;
-    for (auto i = pairs.begin(); i != pairs.end(); ++i) {
-      TemplatePair pair = i->first;
-      BigInt count = i->second;
-      optional<char> insertion = rules.output(pair.characters);
-      if (!insertion.has_value()) {
-        new_pairs[pair] += count;
+// Expresses one insertion step as a linear map over the counts of the pairs
+// that can ever appear, and raises it to any step count by repeated squaring.
+// Squares are kept, so answering several step counts shares them.
+template <typename T>
+struct PolymerGrowth {
+  // `pair_index` values of the reachable pairs, in matrix order.
+  vector<int> pairs;
+  vector<T> initial_counts;
+  int last_element;
+  // `powers[i]` advances the counts by 2^i steps.
+  vector<Matrix<T>> powers;
+
+  PolymerGrowth(const Template& my_template, const Rules& rules) : last_element(my_template.last_element) {
+    array<int, pair_count> positions;
+    positions.fill(-1);
+    auto add_pair = [&](int pair) {
+      if (positions[pair] == -1) {
+        positions[pair] = pairs.size();
+        pairs.push_back(pair);
+      }
+    };
+
+    for (int pair = 0; pair < pair_count; ++pair) {
+      if (!my_template.pairs[pair].is_zero())
+        add_pair(pair);
+    }
+    for (size_t i = 0; i < pairs.size(); ++i) {
+      int insertion = rules.insertions[pairs[i]];
+      if (insertion == Rules::no_insertion)
         continue;
+      add_pair(pair_index(pairs[i] / alphabet_size, insertion));
+      add_pair(pair_index(insertion, pairs[i] % alphabet_size));
+    }
+
+    Matrix<T> step(pairs.size());
+    for (size_t i = 0; i < pairs.size(); ++i) {
+      int insertion = rules.insertions[pairs[i]];
+      if (insertion == Rules::no_insertion) {
+        step.at(i, i) = step.at(i, i) + T(1);
+      } else {
+        size_t left = positions[pair_index(pairs[i] / alphabet_size, insertion)];
+        size_t right = positions[pair_index(insertion, pairs[i] % alphabet_size)];
+        step.at(left, i) = step.at(left, i) + T(1);
+        step.at(right, i) = step.at(right, i) + T(1);
       }
+    }
+    powers.push_back(step);
 
-      TemplatePair starting({{pair.characters.first, *insertion}, pair.at_start, false});
-      new_pairs[starting] += count;
-      TemplatePair ending({{*insertion, pair.characters.second}, false, pair.at_end});
-      new_pairs[ending] += count;
+    for (size_t i = 0; i < pairs.size(); ++i) {
+      initial_counts.push_back(T(my_template.pairs[pairs[i]].to_uint64()));
     }
-    pairs = new_pairs;
   }
 
-  BigInt score() {
-    map<char, BigInt> counts;
-    for (auto i = pairs.begin(); i != pairs.end(); ++i) {
-      TemplatePair pair = i->first;
-      if (pair.on_edge())
-        continue;
+  vector<T> pair_counts_after(uint64_t steps) {
+    vector<T> counts = initial_counts;
+    for (size_t bit = 0; (steps >> bit) > 0; ++bit) {
+      if (bit == powers.size())
+        powers.push_back(powers.back() * powers.back());
+      if ((steps >> bit) & 1)
+        counts = powers[bit] * counts;
+    }
+    return counts;
+  }
 
-      BigInt count = i->second;
-      counts[pair.characters.first] += count;
-      counts[pair.characters.second] += count;
+  array<T, alphabet_size> element_counts_after(uint64_t steps) {
+    vector<T> counts = pair_counts_after(steps);
+    array<T, alphabet_size> result;
+    result.fill(T(0));
+    for (size_t i = 0; i < pairs.size(); ++i) {
+      int element = pairs[i] / alphabet_size;
+      result[element] = result[element] + counts[i];
     }
+    result[last_element] = result[last_element] + T(1);
+    return result;
+  }
+};
 
-    // middle values are double counted because adjacent pairs overlap
-    for (auto i = counts.begin(); i != counts.end(); ++i)
-      counts[i->first] = i->second / 2;
+// Scores for arbitrary step counts. Up to `max_exact_steps` the template is
+// stepped forward with exact counts, through the requested step counts in
+// order so each step is only simulated once. Beyond that scores are given
+// modulo `ModularCount::modulus`, with the most and least common elements
+// picked from approximate counts.
+struct ScoreCalculator {
+  static constexpr uint64_t max_exact_steps = 10000;
+  // Approximate counts this close, relative to their size, might be ranked
+  // the wrong way round.
+  static constexpr double tie_tolerance = 1e-9;
+
+  Template exact;
+  uint64_t exact_steps = 0;
+  PolymerGrowth<ModularCount> modular;
+  PolymerGrowth<ScaledCount> approximate;
+
+  ScoreCalculator(const Template& my_template, const Rules& rules)
+    : exact(my_template), modular(my_template, rules), approximate(my_template, rules) {}
+
+  bool is_exact(uint64_t steps) const { return steps <= max_exact_steps; }
+
+  // Step counts must not decrease between calls.
+  Count exact_score_after(uint64_t steps, const Rules& rules) {
+    if (steps < exact_steps)
+      abort();
+    for (; exact_steps < steps; ++exact_steps)
+      exact.advance(rules);
+    return exact.score();
+  }
 
-    for (auto i = pairs.begin(); i != pairs.end(); ++i) {
-      TemplatePair pair = i->first;
-      if (!pair.on_edge())
+  // Returns nullopt if another element's approximate count is too close to
+  // the most or least common one's to tell which is which, and picking it
+  // would change the score.
+  optional<uint64_t> modular_score_after(uint64_t steps) {
+    array<ScaledCount, alphabet_size> approximate_counts = approximate.element_counts_after(steps);
+    int most_common = -1;
+    int least_common = -1;
+    for (int element = 0; element < alphabet_size; ++element) {
+      if (approximate_counts[element].mantissa == 0)
         continue;
-
-      BigInt count = i->second;
-      counts[pair.characters.first] += count;
-      counts[pair.characters.second] += count;
+      if (most_common == -1 || approximate_counts[most_common] < approximate_counts[element])
+        most_common = element;
+      if (least_common == -1 || approximate_counts[element] < approximate_counts[least_common])
+        least_common = element;
     }
 
-    optional<BigInt> max_value;
-    optional<BigInt> min_value;
-    for (auto i = counts.begin(); i != counts.end(); ++i) {
-      BigInt count = i->second;
-      if (!max_value.has_value())
-        max_value = count;
-      else
-        max_value = max(*max_value, count);
-
-      if (!min_value.has_value())
-        min_value = count;
-      else
-        min_value = min(*min_value, count);
+    array<ModularCount, alphabet_size> counts = modular.element_counts_after(steps);
+    for (int element = 0; element < alphabet_size; ++element) {
+      if (approximate_counts[element].mantissa == 0)
+        continue;
+      for (int chosen : {most_common, least_common}) {
+        if (approximate_counts[element].is_close_to(approximate_counts[chosen], tie_tolerance) &&
+            counts[element].value != counts[chosen].value)
+          return nullopt;
+      }
     }
 
-    return *max_value - *min_value;
+    uint64_t modulus = ModularCount::modulus;
+    return (counts[most_common].value + modulus - counts[least_common].value) % modulus;
   }
 };
 
@@ -442,13 +359,14 @@ vector<string> split(string str, string token){
 }
 
 Template parse_template(string str) {
-  map<TemplatePair, BigInt> pairs;
-  for (int i = 0; i < str.size() - 1; ++i) {
-    CharacterPair characters = {str[i], str[i + 1]};
-    TemplatePair pair = {characters, i == 0, i == str.size() - 2};
-    pairs[pair]++;
+  if (str.empty())
+    abort();
+
+  Template result = {{}, element_index(str.back())};
+  for (size_t i = 0; i + 1 < str.size(); ++i) {
+    result.pairs[pair_index(element_index(str[i]), element_index(str[i + 1]))] += 1;
   }
-  return {pairs};
+  return result;
 }
 
 Rule parse_rule(string input) {
@@ -458,21 +376,20 @@ Rule parse_rule(string input) {
 
 // MARK: - Parts 1 & 2
 
-BigInt score_after(int steps, Template my_template, Rules rules) {
-  for (int i = 0; i < steps; ++i)
+// Part 2 continues from the template part 1 leaves behind.
+Count part1(Template& my_template, const Rules& rules) {
+  for (int i = 0; i < 10; ++i)
     my_template.advance(rules);
   return my_template.score();
 }
 
-BigInt part1(Template my_template, Rules rules) {
-  return score_after(10, my_template, rules);
-}
-
-BigInt part2(Template my_template, Rules rules) {
-  return score_after(40, my_template, rules);
+Count part2(Template& my_template, const Rules& rules) {
+  for (int i = 10; i < 40; ++i)
+    my_template.advance(rules);
+  return my_template.score();
 }
 
-int main() {
+int main(int argc, char** argv) {
   // MARK: - Read Input
 
   ifstream is("input.txt");
@@ -488,6 +405,31 @@ int main() {
 
   Template my_template = parse_template(*template_str);
   Rules rules({parsed_rules});
+
+  // Optionally score other step counts, however large.
+  if (argc > 1) {
+    vector<uint64_t> step_counts;
+    for (int i = 1; i < argc; ++i)
+      step_counts.push_back(stoull(argv[i]));
+    sort(step_counts.begin(), step_counts.end());
+
+    ScoreCalculator calculator(my_template, rules);
+    for (auto steps = step_counts.begin(); steps != step_counts.end(); ++steps) {
+      cout << "Score after " << *steps << " steps: ";
+      if (calculator.is_exact(*steps)) {
+        cout << calculator.exact_score_after(*steps, rules) << endl;
+      } else {
+        optional<uint64_t> score = calculator.modular_score_after(*steps);
+        if (score.has_value()) {
+          cout << *score << " (mod " << ModularCount::modulus << ")" << endl;
+        } else {
+          cout << "ambiguous, the most or least common elements are too close to tell apart" << endl;
+        }
+      }
+    }
+    return 0;
+  }
+
   cout << "Part 1: " << part1(my_template, rules) << endl;
   cout << "Part 2: " << part2(my_template, rules) << endl;
   return 0;
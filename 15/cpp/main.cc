@@ -1,18 +1,446 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
 using namespace std;
 
+// MARK: - Models
+
+typedef uint8_t Risk;
+
+const Risk max_risk = 9;
+
+struct RiskMap {
+  int width;
+  int height;
+  // Row-major risks.
+  vector<Risk> risks;
+
+  int size() const { return width * height; }
+
+  Risk at(int x, int y) const {
+    return risks[y * width + x];
+  }
+};
+
+// The map repeated `factor` times in each direction, each repetition right or
+// down adding one to every risk and wrapping from nine back to one. Risks are
+// computed from the original map when asked for rather than stored, using
+// per-column and per-row tables of which tile and original position they
+// fall on.
+struct TiledRiskMap {
+  const RiskMap& map;
+  int factor;
+  int width;
+  int height;
+  vector<int> source_x;
+  vector<int> tile_x;
+  vector<int> source_row_start;
+  vector<int> tile_y;
+
+  TiledRiskMap(const RiskMap& map, int factor)
+    : map(map), factor(factor), width(map.width * factor), height(map.height * factor) {
+    for (int x = 0; x < width; ++x) {
+      source_x.push_back(x % map.width);
+      tile_x.push_back(x / map.width);
+    }
+    for (int y = 0; y < height; ++y) {
+      source_row_start.push_back(y % map.height * map.width);
+      tile_y.push_back(y / map.height);
+    }
+  }
+
+  uint64_t size() const { return (uint64_t)width * height; }
+
+  Risk at(int x, int y) const {
+    Risk risk = map.risks[source_row_start[y] + source_x[x]];
+    return (risk - 1 + tile_x[x] + tile_y[y]) % max_risk + 1;
+  }
+};
+
+// MARK: - Shortest Path
+
+struct Position {
+  int x;
+  int y;
+};
+
+// A priority queue for Dijkstra's algorithm when every edge costs between one
+// and `max_risk` (Dial's algorithm). Pending priorities never span more than
+// `max_risk + 2` consecutive values, even with A*'s heuristic changing by one
+// per step, so one bucket per value, reused circularly, keeps them in order
+// without a heap. Buckets are drained first in, first out, which keeps the
+// search front moving through memory in order.
+struct BucketQueue {
+  static constexpr int bucket_count = max_risk + 2;
+
+  array<vector<Position>, bucket_count> buckets;
+  array<size_t, bucket_count> bucket_heads = {};
+  uint32_t current_total;
+  size_t pending = 0;
+
+  // Nothing may be pushed below `first_total`.
+  BucketQueue(uint32_t first_total = 0) : current_total(first_total) {}
+
+  void push(Position position, uint32_t total) {
+    buckets[total % bucket_count].push_back(position);
+    pending++;
+  }
+
+  // The lowest pending total, or UINT32_MAX once the queue is empty.
+  uint32_t min_total() {
+    if (pending == 0)
+      return UINT32_MAX;
+    while (bucket_heads[current_total % bucket_count] == buckets[current_total % bucket_count].size())
+      current_total++;
+    return current_total;
+  }
+
+  // Returns false once the queue is empty. Cells may come out more than once
+  // if they were pushed again with a lower total, and the caller skips the
+  // stale entries.
+  bool pop(Position& position, uint32_t& total) {
+    if (min_total() == UINT32_MAX)
+      return false;
+    vector<Position>& bucket = buckets[current_total % bucket_count];
+    size_t& head = bucket_heads[current_total % bucket_count];
+    position = bucket[head++];
+    if (head == bucket.size()) {
+      bucket.clear();
+      head = 0;
+    }
+    pending--;
+    total = current_total;
+    return true;
+  }
+};
+
+// Best totals found so far for every position, in a flat array.
+struct DenseTotals {
+  int width;
+  vector<uint32_t> totals;
+
+  DenseTotals(const TiledRiskMap& map) : width(map.width), totals(map.size(), UINT32_MAX) {}
+
+  // UINT32_MAX for positions not reached yet.
+  uint32_t total(Position position) const {
+    return totals[(uint64_t)position.y * width + position.x];
+  }
+
+  bool is_current(Position position, uint32_t total) const {
+    return this->total(position) == total;
+  }
+
+  bool improve(Position position, uint32_t total) {
+    uint32_t& current = totals[(uint64_t)position.y * width + position.x];
+    if (total >= current)
+      return false;
+    current = total;
+    return true;
+  }
+
+  void settle(Position) {}
+};
+
+// Best totals found so far only for positions near the search front. Once a
+// position and all of its neighbors are settled nothing can relax it again,
+// so it's forgotten, and memory follows the size of the front rather than
+// the map.
+struct BandedTotals {
+  struct Entry {
+    uint32_t total;
+    uint8_t settled_neighbors;
+    bool settled;
+  };
+
+  const TiledRiskMap& map;
+  unordered_map<uint64_t, Entry> entries;
+
+  BandedTotals(const TiledRiskMap& map) : map(map) {}
+
+  uint64_t key(Position position) const {
+    return (uint64_t)position.y * map.width + position.x;
+  }
+
+  int neighbor_count(Position position) const {
+    return (position.x > 0) + (position.x + 1 < map.width) + (position.y > 0) + (position.y + 1 < map.height);
+  }
+
+  // Forgotten positions were settled, so their entries are never current.
+  bool is_current(Position position, uint32_t total) const {
+    auto entry = entries.find(key(position));
+    return entry != entries.end() && !entry->second.settled && entry->second.total == total;
+  }
+
+  bool improve(Position position, uint32_t total) {
+    auto inserted = entries.insert({key(position), {total, 0, false}});
+    if (inserted.second)
+      return true;
+    Entry& entry = inserted.first->second;
+    if (entry.settled || total >= entry.total)
+      return false;
+    entry.total = total;
+    return true;
+  }
+
+  // Called after relaxing every neighbor, so they all have entries.
+  void settle(Position position) {
+    auto visit = [&](Position neighbor) {
+      auto entry = entries.find(key(neighbor));
+      if (entry == entries.end())
+        return;
+      entry->second.settled_neighbors++;
+      if (entry->second.settled && entry->second.settled_neighbors == neighbor_count(neighbor))
+        entries.erase(entry);
+    };
+    if (position.x > 0)
+      visit({position.x - 1, position.y});
+    if (position.x + 1 < map.width)
+      visit({position.x + 1, position.y});
+    if (position.y > 0)
+      visit({position.x, position.y - 1});
+    if (position.y + 1 < map.height)
+      visit({position.x, position.y + 1});
+
+    auto entry = entries.find(key(position));
+    entry->second.settled = true;
+    if (entry->second.settled_neighbors == neighbor_count(position))
+      entries.erase(entry);
+  }
+};
+
+// What a search did, for comparing strategies.
+struct SearchStats {
+  // Positions whose lowest total was final when they left the queue.
+  uint64_t settled = 0;
+  // The most entries waiting in the queues at once, stale ones included.
+  size_t peak_frontier = 0;
+};
+
+enum SearchMode { dijkstra, a_star, bidirectional };
+
+// Dijkstra's algorithm is A* without a heuristic.
+struct NoHeuristic {
+  uint32_t operator()(Position) const { return 0; }
+};
+
+// Every step into a position costs at least one, so the Manhattan distance to
+// the bottom right never overestimates the remaining risk. It changes by one
+// per step, so it's also consistent and positions still settle the first time
+// they leave the queue.
+struct ManhattanHeuristic {
+  static constexpr uint32_t min_step_risk = 1;
+
+  int width;
+  int height;
+
+  uint32_t operator()(Position position) const {
+    return min_step_risk * ((width - 1 - position.x) + (height - 1 - position.y));
+  }
+};
+
+// Calls `visitor` with each position next to `position` that's on the map.
+template <typename Visitor>
+void visit_neighbors(const TiledRiskMap& map, Position position, Visitor visitor) {
+  if (position.x > 0)
+    visitor(Position{position.x - 1, position.y});
+  if (position.x + 1 < map.width)
+    visitor(Position{position.x + 1, position.y});
+  if (position.y > 0)
+    visitor(Position{position.x, position.y - 1});
+  if (position.y + 1 < map.height)
+    visitor(Position{position.x, position.y + 1});
+}
+
+// The lowest total risk of any path from the top left to the bottom right,
+// not counting the risk of the starting position. Positions are queued by
+// their total plus the heuristic's estimate of the risk still to come.
+template <typename Totals, typename Heuristic>
+uint32_t lowest_total_risk(const TiledRiskMap& map, Totals& totals, Heuristic heuristic, SearchStats& stats) {
+  BucketQueue queue(heuristic({0, 0}));
+  totals.improve({0, 0}, 0);
+  queue.push({0, 0}, heuristic({0, 0}));
+
+  Position position;
+  uint32_t priority;
+  while (queue.pop(position, priority)) {
+    uint32_t total = priority - heuristic(position);
+    if (!totals.is_current(position, total))
+      continue;
+    stats.settled++;
+    if (position.x == map.width - 1 && position.y == map.height - 1)
+      return total;
+
+    visit_neighbors(map, position, [&](Position neighbor) {
+      uint32_t neighbor_total = total + map.at(neighbor.x, neighbor.y);
+      if (totals.improve(neighbor, neighbor_total))
+        queue.push(neighbor, neighbor_total + heuristic(neighbor));
+    });
+    totals.settle(position);
+    stats.peak_frontier = max(stats.peak_frontier, queue.pending);
+  }
+  abort();
+}
+
+// Searches forward from the top left and backward from the bottom right at
+// once, always advancing the side with fewer queued positions, and stops when
+// the two lowest queued totals together can't beat the best path seen where
+// the searches meet. Backward totals count the risk of every position after
+// the one they're for, so a path's total is the forward plus backward total
+// of any position on it. Both directions need their totals until the end to
+// find meeting points, so they're kept for every position.
+uint32_t bidirectional_lowest_total_risk(const TiledRiskMap& map, SearchStats& stats) {
+  Position start = {0, 0};
+  Position end = {map.width - 1, map.height - 1};
+  DenseTotals forward_totals(map);
+  DenseTotals backward_totals(map);
+  BucketQueue forward_queue;
+  BucketQueue backward_queue;
+  forward_totals.improve(start, 0);
+  forward_queue.push(start, 0);
+  backward_totals.improve(end, 0);
+  backward_queue.push(end, 0);
+
+  uint32_t best = map.size() == 1 ? 0 : UINT32_MAX;
+  auto meet = [&](Position position) {
+    uint32_t forward_total = forward_totals.total(position);
+    uint32_t backward_total = backward_totals.total(position);
+    if (forward_total != UINT32_MAX && backward_total != UINT32_MAX)
+      best = min(best, forward_total + backward_total);
+  };
+
+  while (true) {
+    uint32_t forward_min = forward_queue.min_total();
+    uint32_t backward_min = backward_queue.min_total();
+    if (forward_min == UINT32_MAX || backward_min == UINT32_MAX || forward_min + backward_min >= best)
+      break;
+
+    Position position = start;
+    uint32_t total;
+    if (forward_queue.pending <= backward_queue.pending) {
+      if (!forward_queue.pop(position, total))
+        break;
+      if (!forward_totals.is_current(position, total))
+        continue;
+      visit_neighbors(map, position, [&](Position neighbor) {
+        if (forward_totals.improve(neighbor, total + map.at(neighbor.x, neighbor.y)))
+          forward_queue.push(neighbor, forward_totals.total(neighbor));
+        meet(neighbor);
+      });
+    } else {
+      if (!backward_queue.pop(position, total))
+        break;
+      if (!backward_totals.is_current(position, total))
+        continue;
+      // Stepping back from here means stepping into here going forward.
+      uint32_t step_risk = map.at(position.x, position.y);
+      visit_neighbors(map, position, [&](Position neighbor) {
+        if (backward_totals.improve(neighbor, total + step_risk))
+          backward_queue.push(neighbor, backward_totals.total(neighbor));
+        meet(neighbor);
+      });
+    }
+    stats.settled++;
+    stats.peak_frontier = max(stats.peak_frontier, forward_queue.pending + backward_queue.pending);
+  }
+  if (best == UINT32_MAX)
+    abort();
+  return best;
+}
+
+// Maps up to this many positions keep a total for every position.
+const uint64_t max_dense_positions = 1 << 28;
+
+uint32_t lowest_total_risk(const TiledRiskMap& map, SearchMode mode, SearchStats& stats) {
+  if (mode == bidirectional)
+    return bidirectional_lowest_total_risk(map, stats);
+
+  auto search = [&](auto& totals) {
+    if (mode == a_star)
+      return lowest_total_risk(map, totals, ManhattanHeuristic{map.width, map.height}, stats);
+    return lowest_total_risk(map, totals, NoHeuristic(), stats);
+  };
+  if (map.size() <= max_dense_positions) {
+    DenseTotals totals(map);
+    return search(totals);
+  }
+  BandedTotals totals(map);
+  return search(totals);
+}
+
+// MARK: - Parsers
+
+Risk parse_risk(char input) {
+  if (input < '1' || input > '9')
+    abort();
+  return input - '0';
+}
+
 // MARK: - Parts 1 & 2
 
-int part1() {
-  return 0;
+uint32_t part1(const RiskMap& map, SearchMode mode, SearchStats& stats) {
+  return lowest_total_risk(TiledRiskMap(map, 1), mode, stats);
 }
 
-int part2() {
-  return 0;
+uint32_t part2(const RiskMap& map, int tile_factor, SearchMode mode, SearchStats& stats) {
+  return lowest_total_risk(TiledRiskMap(map, tile_factor), mode, stats);
+}
+
+void print_stats(const SearchStats& stats) {
+  cout << "  " << stats.settled << " settled, peak frontier " << stats.peak_frontier << endl;
 }
 
-int main() {
-  cout << "Part 1: " << part1() << endl;
-  cout << "Part 1: " << part2() << endl;
+int main(int argc, char** argv) {
+  // MARK: - Read Input
+
+  ifstream is("input.txt");
+  string str;
+  RiskMap map = {0, 0, {}};
+  while (getline(is, str)) {
+    if (str.empty())
+      continue;
+    if (map.height > 0 && (int)str.size() != map.width)
+      abort();
+    map.width = str.size();
+    map.height++;
+    for (auto i = str.begin(); i != str.end(); ++i)
+      map.risks.push_back(parse_risk(*i));
+  }
+
+  // Part 2 can optionally tile the map some other number of times, and
+  // choosing a search strategy also prints what each search did.
+  int tile_factor = 5;
+  SearchMode mode = dijkstra;
+  bool show_stats = false;
+  for (int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    if (arg == "--dijkstra") {
+      mode = dijkstra;
+      show_stats = true;
+    } else if (arg == "--a-star") {
+      mode = a_star;
+      show_stats = true;
+    } else if (arg == "--bidirectional") {
+      mode = bidirectional;
+      show_stats = true;
+    } else {
+      tile_factor = stoi(arg);
+    }
+  }
+  if (tile_factor < 1)
+    abort();
+
+  SearchStats stats1;
+  cout << "Part 1: " << part1(map, mode, stats1) << endl;
+  if (show_stats)
+    print_stats(stats1);
+  SearchStats stats2;
+  cout << "Part 2: " << part2(map, tile_factor, mode, stats2) << endl;
+  if (show_stats)
+    print_stats(stats2);
   return 0;
 }
@@ -1,18 +1,426 @@
+#include <array>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 using namespace std;
 
+// MARK: - Models
+
+enum PacketType {
+  sum = 0,
+  product = 1,
+  minimum = 2,
+  maximum = 3,
+  literal = 4,
+  greater_than = 5,
+  less_than = 6,
+  equals = 7,
+};
+
+// An operator packet whose sub-packets are still being decoded. Their values
+// are folded in as they complete, so nothing but the running value is kept.
+struct OpenOperator {
+  PacketType type;
+  // Whether `limit` is the bit position the sub-packets end at, or else how
+  // many sub-packets there are.
+  bool limit_is_end_position;
+  uint64_t limit;
+  uint64_t child_count = 0;
+  uint64_t value = 0;
+  // Its number in the packet index, if one is being built.
+  uint32_t packet = 0;
+
+  OpenOperator(PacketType type, bool limit_is_end_position, uint64_t limit)
+    : type(type), limit_is_end_position(limit_is_end_position), limit(limit) {}
+
+  void add(uint64_t child_value) {
+    child_count++;
+    switch (type) {
+    case sum:
+      value += child_value;
+      break;
+    case product:
+      value = child_count == 1 ? child_value : value * child_value;
+      break;
+    case minimum:
+      value = child_count == 1 ? child_value : min(value, child_value);
+      break;
+    case maximum:
+      value = child_count == 1 ? child_value : max(value, child_value);
+      break;
+    case greater_than:
+    case less_than:
+    case equals:
+      // Comparisons hold on to their first operand until the second arrives.
+      if (child_count == 1) {
+        value = child_value;
+      } else if (child_count == 2) {
+        value = type == greater_than ? value > child_value : type == less_than ? value < child_value : value == child_value;
+      } else {
+        abort();
+      }
+      break;
+    case literal:
+      abort();
+    }
+  }
+
+  // Aborts if the sub-packets overran their length, or there are too few of
+  // them for the operator.
+  bool is_complete(uint64_t position) const {
+    bool complete = limit_is_end_position ? position >= limit : child_count == limit;
+    if (!complete)
+      return false;
+    if (limit_is_end_position && position > limit)
+      abort();
+    if (child_count == 0 || (type >= greater_than && child_count != 2))
+      abort();
+    return true;
+  }
+};
+
+struct Evaluation {
+  uint64_t version_sum;
+  uint64_t value;
+};
+
+// MARK: - Hex Conversion
+
+// Every byte maps to its hex digit's value, or `not_hex`.
+const uint8_t not_hex = 0xFF;
+
+array<uint8_t, 256> make_hex_values() {
+  array<uint8_t, 256> values;
+  values.fill(not_hex);
+  for (int i = 0; i < 10; ++i)
+    values['0' + i] = i;
+  for (int i = 0; i < 6; ++i) {
+    values['A' + i] = 10 + i;
+    values['a' + i] = 10 + i;
+  }
+  return values;
+}
+
+const array<uint8_t, 256> hex_values = make_hex_values();
+
+// Sixteen bytes handled as one vector, using the compiler's vector extensions
+// so it lowers to SSE on x86 and NEON on ARM.
+typedef uint8_t CharVector __attribute__((vector_size(16)));
+typedef uint16_t PairVector __attribute__((vector_size(16)));
+typedef uint8_t HalfCharVector __attribute__((vector_size(8)));
+
+// Converts hex digits to bytes sixteen at a time, stopping before the first
+// block with anything else in it, and returns how many digits it converted.
+// Digits keep their value in their low nibble, and letters, the only ones
+// with bit 6 set, are nine more than theirs. Each pair of nibbles is then
+// joined in its 16-bit lane and the lanes narrowed to bytes.
+size_t convert_hex_blocks(const char* digits, size_t count, uint8_t* bytes) {
+  size_t converted = 0;
+  for (; converted + 16 <= count; converted += 16) {
+    CharVector chars;
+    memcpy(&chars, digits + converted, 16);
+    CharVector lowercase = chars | 0x20;
+    CharVector valid = (CharVector)(((chars >= '0') & (chars <= '9')) | ((lowercase >= 'a') & (lowercase <= 'f')));
+    uint64_t valid_halves[2];
+    memcpy(valid_halves, &valid, 16);
+    if ((valid_halves[0] & valid_halves[1]) != UINT64_MAX)
+      break;
+
+    CharVector nibbles = (chars & 0x0F) + ((chars >> 6) & 1) * 9;
+    PairVector pairs = (PairVector)nibbles;
+    HalfCharVector packed = __builtin_convertvector(((pairs & 0x0F) << 4) | (pairs >> 8), HalfCharVector);
+    memcpy(bytes + converted / 2, &packed, 8);
+  }
+  return converted;
+}
+
+// The transmission as packed bytes, an odd final digit filling the high half
+// of the last one.
+struct Transmission {
+  // Padded with zeros so a whole word can always be loaded from any byte.
+  vector<uint8_t> bytes;
+  uint64_t bit_count;
+};
+
+const size_t transmission_padding = 8;
+
+// Aborts on anything but hex digits before trailing whitespace.
+Transmission parse_transmission(const char* begin, const char* end) {
+  size_t size = end - begin;
+  Transmission transmission;
+  transmission.bytes.assign((size + 1) / 2 + transmission_padding, 0);
+  uint8_t* bytes = transmission.bytes.data();
+
+  size_t digit_count = convert_hex_blocks(begin, size, bytes);
+  for (; digit_count < size; ++digit_count) {
+    uint8_t value = hex_values[(uint8_t)begin[digit_count]];
+    if (value == not_hex)
+      break;
+    bytes[digit_count / 2] |= digit_count % 2 == 0 ? value << 4 : value;
+  }
+  for (const char* i = begin + digit_count; i != end; ++i) {
+    if (*i != '\n' && *i != '\r' && *i != ' ')
+      abort();
+  }
+  transmission.bytes.resize((digit_count + 1) / 2 + transmission_padding);
+  transmission.bit_count = digit_count * 4;
+  return transmission;
+}
+
+// MARK: - Bit Reader
+
+// Reads bits most significant first from packed bytes. Bits are buffered
+// left-aligned in a 64-bit word, which is topped up with a single unaligned
+// load of the bytes after the ones it holds.
+struct BitReader {
+  const uint8_t* next_byte;
+  uint64_t bit_count;
+  uint64_t buffer = 0;
+  int buffered = 0;
+  // Bits read so far.
+  uint64_t position = 0;
+
+  BitReader(const Transmission& transmission)
+    : next_byte(transmission.bytes.data()), bit_count(transmission.bit_count) {}
+
+  // Leaves at least 56 bits buffered. Past the end of the transmission they
+  // come from the padding.
+  void refill() {
+    uint64_t word;
+    memcpy(&word, next_byte, 8);
+    buffer |= __builtin_bswap64(word) >> buffered;
+    next_byte += (63 - buffered) >> 3;
+    buffered |= 56;
+  }
+
+  // Reads up to 32 bits, aborting if the transmission ends first.
+  uint32_t read(int count) {
+    if (position + count > bit_count)
+      abort();
+    if (buffered < count)
+      refill();
+    uint32_t result = buffer >> (64 - count);
+    buffer <<= count;
+    buffered -= count;
+    position += count;
+    return result;
+  }
+};
+
+// MARK: - Packet Index
+
+const char* type_names[] = {
+  "sum", "product", "minimum", "maximum", "literal", "greater than", "less than", "equal to",
+};
+
+// Every packet, numbered in the order they start, with one array per field.
+// A packet's descendants are the packets after it up to its subtree end, so
+// its sub-packets are found by starting at the next packet and skipping a
+// subtree at a time.
+struct PacketIndex {
+  vector<uint64_t> bit_offsets;
+  vector<uint64_t> bit_lengths;
+  vector<uint8_t> versions;
+  vector<uint8_t> types;
+  vector<uint32_t> subtree_ends;
+  // Zero for operators.
+  vector<uint64_t> literal_values;
+
+  uint32_t size() const { return subtree_ends.size(); }
+
+  // Adds a packet once its header has been read.
+  uint32_t add(uint64_t bit_offset, uint8_t version, PacketType type) {
+    if (size() == UINT32_MAX)
+      abort();
+    bit_offsets.push_back(bit_offset);
+    bit_lengths.push_back(0);
+    versions.push_back(version);
+    types.push_back(type);
+    subtree_ends.push_back(0);
+    literal_values.push_back(0);
+    return size() - 1;
+  }
+
+  // Completes a packet once it and all of its sub-packets have been read.
+  void finish(uint32_t packet, uint64_t end_position, uint64_t literal_value) {
+    bit_lengths[packet] = end_position - bit_offsets[packet];
+    subtree_ends[packet] = size();
+    literal_values[packet] = literal_value;
+  }
+
+  // Evaluates a packet from its entries alone. Its descendants are visited
+  // last to first, so each operator finds its sub-packets' values on top of
+  // the stack, first sub-packet uppermost.
+  Evaluation evaluate(uint32_t packet) const {
+    uint64_t version_sum = 0;
+    vector<uint64_t> values;
+    for (uint32_t i = subtree_ends[packet]; i-- > packet;) {
+      version_sum += versions[i];
+      if (types[i] == literal) {
+        values.push_back(literal_values[i]);
+        continue;
+      }
+      uint64_t child_count = 0;
+      for (uint32_t child = i + 1; child < subtree_ends[i]; child = subtree_ends[child])
+        child_count++;
+      OpenOperator op(PacketType(types[i]), false, child_count);
+      for (; child_count > 0; --child_count) {
+        op.add(values.back());
+        values.pop_back();
+      }
+      values.push_back(op.value);
+    }
+    return {version_sum, values.back()};
+  }
+
+  // Writes one line per packet in the subtree, indented by depth.
+  void dump(uint32_t packet, ostream& out) const {
+    vector<uint32_t> open_subtree_ends;
+    for (uint32_t i = packet; i < subtree_ends[packet]; ++i) {
+      while (!open_subtree_ends.empty() && open_subtree_ends.back() <= i)
+        open_subtree_ends.pop_back();
+      out << string(2 * open_subtree_ends.size(), ' ') << '#' << i << ' ' << type_names[types[i]];
+      if (types[i] == literal)
+        out << ' ' << literal_values[i];
+      out << ", version " << (int)versions[i] << ", bits " << bit_offsets[i] << ".."
+          << bit_offsets[i] + bit_lengths[i] << endl;
+      if (types[i] != literal)
+        open_subtree_ends.push_back(subtree_ends[i]);
+    }
+  }
+};
+
+// MARK: - Decoder
+
+// Decodes the outermost packet in a single pass, indexing every packet if
+// given an index. Operators waiting on their sub-packets are kept on an
+// explicit stack rather than the call stack, so nesting depth is only limited
+// by memory.
+Evaluation evaluate(BitReader& reader, PacketIndex* index = nullptr) {
+  vector<OpenOperator> open_operators;
+  uint64_t version_sum = 0;
+  while (true) {
+    uint64_t bit_offset = reader.position;
+    uint8_t version = reader.read(3);
+    PacketType type = PacketType(reader.read(3));
+    version_sum += version;
+    uint32_t packet = index ? index->add(bit_offset, version, type) : 0;
+    if (type != literal) {
+      uint64_t limit;
+      if (reader.read(1) == 0) {
+        limit = reader.read(15);
+        open_operators.emplace_back(type, true, reader.position + limit);
+      } else {
+        limit = reader.read(11);
+        open_operators.emplace_back(type, false, limit);
+      }
+      // Operators always have sub-packets.
+      if (limit == 0)
+        abort();
+      open_operators.back().packet = packet;
+      continue;
+    }
+
+    uint64_t value = 0;
+    uint32_t group;
+    do {
+      group = reader.read(5);
+      if (value >> 60)
+        abort();
+      value = (value << 4) | (group & 0xF);
+    } while (group & 0x10);
+    if (index)
+      index->finish(packet, reader.position, value);
+
+    // Hand the value up through every operator it completes.
+    while (true) {
+      if (open_operators.empty())
+        return {version_sum, value};
+      OpenOperator& parent = open_operators.back();
+      parent.add(value);
+      if (!parent.is_complete(reader.position))
+        break;
+      value = parent.value;
+      if (index)
+        index->finish(parent.packet, reader.position, 0);
+      open_operators.pop_back();
+    }
+  }
+}
+
+// A read-only memory mapping of a whole file.
+struct MappedFile {
+  const char* data = nullptr;
+  size_t size = 0;
+
+  MappedFile(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+      abort();
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+      abort();
+    size = st.st_size;
+    if (size > 0) {
+      void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped == MAP_FAILED)
+        abort();
+      data = (const char*)mapped;
+    }
+    close(fd);
+  }
+
+  ~MappedFile() {
+    if (data != nullptr)
+      munmap((void*)data, size);
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+};
+
 // MARK: - Parts 1 & 2
 
-int part1() {
-  return 0;
+uint64_t part1(const Evaluation& evaluation) {
+  return evaluation.version_sum;
 }
 
-int part2() {
-  return 0;
+uint64_t part2(const Evaluation& evaluation) {
+  return evaluation.value;
 }
 
-int main() {
-  cout << "Part 1: " << part1() << endl;
-  cout << "Part 1: " << part2() << endl;
+int main(int argc, char** argv) {
+  // MARK: - Read Input
+
+  Transmission transmission;
+  {
+    MappedFile input("input.txt");
+    transmission = parse_transmission(input.data, input.data + input.size);
+  }
+
+  // Optionally index every packet, then evaluate and describe one of them.
+  bool show_packet = argc > 2 && string(argv[1]) == "--packet";
+  PacketIndex index;
+  BitReader reader(transmission);
+  Evaluation evaluation = evaluate(reader, show_packet ? &index : nullptr);
+
+  cout << "Part 1: " << part1(evaluation) << endl;
+  cout << "Part 2: " << part2(evaluation) << endl;
+
+  if (show_packet) {
+    uint64_t packet = stoull(argv[2]);
+    if (packet >= index.size())
+      abort();
+    Evaluation packet_evaluation = index.evaluate(packet);
+    cout << "Packet " << packet << ": version sum " << packet_evaluation.version_sum << ", value "
+         << packet_evaluation.value << endl;
+    index.dump(packet, cout);
+  }
   return 0;
 }
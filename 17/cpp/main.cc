@@ -1,18 +1,218 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <vector>
 using namespace std;
 
+// MARK: - Models
+
+struct TargetArea {
+  int64_t min_x;
+  int64_t max_x;
+  int64_t min_y;
+  int64_t max_y;
+};
+
+// Where the probe is along an axis after `steps` steps at an initial
+// `velocity`, if its speed keeps dropping by one each step.
+int64_t position_after(int64_t velocity, int64_t steps) {
+  return steps * velocity - steps * (steps - 1) / 2;
+}
+
+// The last step on which the probe is at or above `position`, for a position
+// at or below zero, so that it's on the way down. Found from the larger root
+// of `position_after(velocity, steps) == position` and then corrected for
+// rounding.
+int64_t last_step_at_or_above(int64_t velocity, int64_t position) {
+  double b = 2 * velocity + 1;
+  int64_t steps = max<int64_t>(0, floor((b + sqrt(b * b - 8.0 * position)) / 2));
+  while (steps > 0 && position_after(velocity, steps) < position)
+    steps--;
+  while (position_after(velocity, steps + 1) >= position)
+    steps++;
+  return steps;
+}
+
+// The first step on which the probe is at or beyond `position`, for a
+// position it reaches before it stops. Found from the smaller root, as above.
+int64_t first_step_reaching(int64_t velocity, int64_t position) {
+  double b = 2 * velocity + 1;
+  int64_t steps = max<int64_t>(0, ceil((b - sqrt(max(0.0, b * b - 8.0 * position))) / 2));
+  while (steps > 0 && position_after(velocity, steps - 1) >= position)
+    steps--;
+  while (position_after(velocity, steps) < position)
+    steps++;
+  return steps;
+}
+
+const int64_t unbounded = INT64_MAX;
+
+// The steps a probe is inside the target along one axis, which are always
+// consecutive.
+struct StepRange {
+  int64_t first;
+  int64_t last;
+
+  bool is_empty() const { return first > last; }
+};
+
+// When a probe launched up or down at `velocity` is level with the target.
+// The target must be below the launcher.
+StepRange y_steps(int64_t velocity, const TargetArea& area) {
+  return {last_step_at_or_above(velocity, area.max_y + 1) + 1, last_step_at_or_above(velocity, area.min_y)};
+}
+
+// When a probe launched forward at `velocity` is lined up with the target
+// from `min_x` to `max_x`, for a positive `min_x`. Probes that stop inside it
+// stay there.
+StepRange x_steps(int64_t velocity, int64_t min_x, int64_t max_x) {
+  int64_t stop = position_after(velocity, velocity);
+  if (stop < min_x)
+    return {1, 0};
+  int64_t first = first_step_reaching(velocity, min_x);
+  int64_t last = stop <= max_x ? unbounded : first_step_reaching(velocity, max_x + 1) - 1;
+  return {first, last};
+}
+
+// For every step until horizontal velocities have all either stopped in the
+// target or passed it, how many have reached the target by then and how many
+// have already left it. Since each velocity is lined up with the target for
+// consecutive steps, the number lined up at some step in a range is the
+// number that arrived by its end minus the number that left before its start.
+struct XStepTables {
+  vector<uint64_t> arrived_by;
+  vector<uint64_t> left_before;
+
+  XStepTables(int64_t max_step) : arrived_by(max_step + 2, 0), left_before(max_step + 2, 0) {}
+
+  int64_t max_step() const { return arrived_by.size() - 2; }
+
+  void add(StepRange steps) {
+    if (steps.is_empty())
+      return;
+    if (steps.first > max_step() || (steps.last != unbounded && steps.last > max_step()))
+      abort();
+    arrived_by[steps.first]++;
+    if (steps.last != unbounded)
+      left_before[steps.last + 1]++;
+  }
+
+  // Turns the counts added for each step into running totals.
+  void accumulate() {
+    for (size_t i = 1; i < arrived_by.size(); ++i) {
+      arrived_by[i] += arrived_by[i - 1];
+      left_before[i] += left_before[i - 1];
+    }
+  }
+
+  uint64_t count_lined_up(StepRange steps) const {
+    return arrived_by[min(steps.last, max_step())] - left_before[min(steps.first, max_step() + 1)];
+  }
+};
+
+struct Solution {
+  int64_t max_height;
+  uint64_t velocity_count;
+};
+
+// Finds every launch velocity that puts the probe in the target without
+// simulating any of them. Each upward velocity is only level with the target
+// for a range of steps, and the tables count the horizontal velocities lined
+// up with it during that range. Upward velocities beyond the target's depth
+// come back past the launcher too fast to hit it, and horizontal ones beyond
+// its far side overshoot on the first step.
+Solution solve(TargetArea area) {
+  if (area.max_y >= 0)
+    abort();
+  // Aiming backward is the mirror image of aiming forward.
+  if (area.max_x < 0)
+    area = {-area.max_x, -area.min_x, area.min_y, area.max_y};
+
+  int64_t min_velocity_y = area.min_y;
+  int64_t max_velocity_y = -area.min_y - 1;
+  // Moving at `velocity` or more, reaching a distance of `d` takes at most
+  // `2 * d / velocity` steps, and slower than that it takes at most
+  // `velocity` steps, so no velocity needs more than `sqrt(2 * d)`.
+  int64_t max_distance = max(area.max_x, -area.min_x) + 1;
+  XStepTables tables(sqrt(2.0 * max_distance) + 2);
+  for (int64_t velocity = 1; velocity <= area.max_x; ++velocity)
+    tables.add(x_steps(velocity, max<int64_t>(area.min_x, 1), area.max_x));
+  if (area.min_x <= 0) {
+    tables.add({0, unbounded});
+    for (int64_t velocity = 1; velocity <= -area.min_x; ++velocity)
+      tables.add(x_steps(velocity, max<int64_t>(-area.max_x, 1), -area.min_x));
+  }
+  tables.accumulate();
+
+  Solution solution = {0, 0};
+  bool found_highest = false;
+  for (int64_t velocity = max_velocity_y; velocity >= min_velocity_y; --velocity) {
+    StepRange steps = y_steps(velocity, area);
+    if (steps.is_empty())
+      continue;
+    uint64_t count = tables.count_lined_up(steps);
+    if (count > 0 && !found_highest) {
+      solution.max_height = velocity > 0 ? position_after(velocity, velocity) : 0;
+      found_highest = true;
+    }
+    solution.velocity_count += count;
+  }
+  return solution;
+}
+
+// MARK: - Parsers
+
+vector<string> split(string str, string token){
+  vector<string>result;
+  while (str.size()) {
+    int index = str.find(token);
+    if (index != string::npos) {
+      result.push_back(str.substr(0, index));
+      str = str.substr(index+token.size());
+      if (str.empty()) result.push_back(str);
+    } else {
+      result.push_back(str);
+      str = "";
+    }
+  }
+  return result;
+}
+
+// Parses "target area: x=185..221, y=-122..-74".
+TargetArea parse_target_area(string input) {
+  vector<string> axes = split(input, ", ");
+  if (axes.size() != 2)
+    abort();
+  vector<string> x_range = split(split(axes[0], "=")[1], "..");
+  vector<string> y_range = split(split(axes[1], "=")[1], "..");
+  TargetArea area = {stoll(x_range[0]), stoll(x_range[1]), stoll(y_range[0]), stoll(y_range[1])};
+  if (area.min_x > area.max_x || area.min_y > area.max_y)
+    abort();
+  return area;
+}
+
 // MARK: - Parts 1 & 2
 
-int part1() {
-  return 0;
+int64_t part1(const Solution& solution) {
+  return solution.max_height;
 }
 
-int part2() {
-  return 0;
+uint64_t part2(const Solution& solution) {
+  return solution.velocity_count;
 }
 
 int main() {
-  cout << "Part 1: " << part1() << endl;
-  cout << "Part 1: " << part2() << endl;
+  // MARK: - Read Input
+
+  ifstream is("input.txt");
+  string str;
+  getline(is, str);
+  Solution solution = solve(parse_target_area(str));
+
+  cout << "Part 1: " << part1(solution) << endl;
+  cout << "Part 2: " << part2(solution) << endl;
   return 0;
 }
@@ -1,18 +1,307 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
 using namespace std;
 
+// MARK: - Models
+
+// A regular number and how many pairs enclose it.
+struct Element {
+  uint32_t value;
+  uint8_t depth;
+};
+
+// A snailfish number as its regular numbers from left to right. Pairs aren't
+// stored: two neighboring elements at the same depth with nothing between
+// them are always a pair, since the numbers are full binary trees.
+typedef vector<Element> SnailfishNumber;
+
+// A read-only snailfish number stored elsewhere.
+struct NumberView {
+  const Element* elements;
+  size_t size;
+
+  NumberView(const Element* elements, size_t size) : elements(elements), size(size) {}
+  NumberView(const SnailfishNumber& number) : elements(number.data()), size(number.size()) {}
+};
+
+// Pairs nested inside this many others explode.
+const uint8_t max_depth = 4;
+// Regular numbers this large split.
+const uint32_t min_split_value = 10;
+
+// Replaces the regular number at `index` with a pair of its halves.
+void split(SnailfishNumber& number, size_t index) {
+  Element element = number[index];
+  uint8_t depth = element.depth + 1;
+  number[index] = {element.value / 2, depth};
+  number.insert(number.begin() + index + 1, {(element.value + 1) / 2, depth});
+}
+
+// Splits the regular number at `index` into a pair too deep to keep, and
+// explodes it straight away. That leaves a zero in its place, so it's done
+// without moving anything.
+void split_and_explode(SnailfishNumber& number, size_t index) {
+  uint32_t value = number[index].value;
+  if (index > 0)
+    number[index - 1].value += value / 2;
+  if (index + 1 < number.size())
+    number[index + 1].value += (value + 1) / 2;
+  number[index].value = 0;
+}
+
+// Writes the reduced sum of two reduced numbers into `result`, reusing its
+// storage. Only pairs that were at the bottom of either number end up nested
+// too deeply, and exploding doesn't nest anything deeper, so they're exploded
+// as the two are copied in. Splits then go left to right, and a split that
+// makes a pair too deep explodes it at once, which may leave the regular
+// number before it needing to split first.
+void add(NumberView lhs, NumberView rhs, SnailfishNumber& result) {
+  result.clear();
+  uint32_t carry = 0;
+  auto append = [&](NumberView number) {
+    for (size_t i = 0; i < number.size; ++i) {
+      Element element = {number.elements[i].value + carry, (uint8_t)(number.elements[i].depth + 1)};
+      carry = 0;
+      if (element.depth <= max_depth) {
+        result.push_back(element);
+        continue;
+      }
+      // The right half of an exploding pair is always in the same number.
+      if (!result.empty())
+        result.back().value += element.value;
+      carry = number.elements[++i].value;
+      result.push_back({0, max_depth});
+    }
+  };
+  append(lhs);
+  append(rhs);
+
+  size_t i = 0;
+  while (i < result.size()) {
+    if (result[i].value < min_split_value) {
+      i++;
+      continue;
+    }
+    if (result[i].depth < max_depth) {
+      split(result, i);
+    } else {
+      split_and_explode(result, i);
+      if (i > 0)
+        i--;
+    }
+  }
+}
+
+// Three times the left's magnitude plus twice the right's, reduced pair by
+// pair on a stack. Each element either pairs with the one on top of the stack
+// at the same depth, or waits for its sibling to be reduced.
+uint64_t magnitude(const SnailfishNumber& number) {
+  struct Partial {
+    uint64_t magnitude;
+    uint8_t depth;
+  };
+  array<Partial, max_depth + 3> stack;
+  size_t size = 0;
+  for (auto e = number.begin(); e != number.end(); ++e) {
+    Partial partial = {e->value, e->depth};
+    while (size > 0 && stack[size - 1].depth == partial.depth) {
+      partial = {3 * stack[size - 1].magnitude + 2 * partial.magnitude, (uint8_t)(partial.depth - 1)};
+      size--;
+    }
+    if (size == stack.size())
+      abort();
+    stack[size++] = partial;
+  }
+  if (size != 1 || stack[0].depth != 0)
+    abort();
+  return stack[0].magnitude;
+}
+
+// The largest magnitude of any reduced number whose regular numbers add up
+// to each total. Moving a regular number down the left of a pair never
+// lowers the magnitude, so the largest has every regular number at the
+// bottom, and the largest values in the places that count the most.
+const uint32_t max_regular_number = min_split_value - 1;
+const uint32_t max_value_sum = (1 << max_depth) * max_regular_number;
+
+array<uint64_t, max_value_sum + 1> make_max_magnitudes() {
+  vector<uint64_t> weights;
+  for (int left_turns = 0; left_turns <= max_depth; ++left_turns) {
+    uint64_t weight = 1;
+    for (int level = 0; level < max_depth; ++level)
+      weight *= level < left_turns ? 3 : 2;
+    // One place for every order of left and right turns.
+    uint64_t orders = 1;
+    for (int k = 0; k < left_turns; ++k)
+      orders = orders * (max_depth - k) / (k + 1);
+    weights.insert(weights.end(), orders, weight);
+  }
+  sort(weights.begin(), weights.end(), greater<uint64_t>());
+
+  array<uint64_t, max_value_sum + 1> magnitudes;
+  for (uint32_t sum = 0; sum <= max_value_sum; ++sum) {
+    uint64_t magnitude = 0;
+    uint32_t remaining = sum;
+    for (auto w = weights.begin(); w != weights.end() && remaining > 0; ++w) {
+      uint32_t value = min(remaining, max_regular_number);
+      magnitude += *w * value;
+      remaining -= value;
+    }
+    magnitudes[sum] = magnitude;
+  }
+  return magnitudes;
+}
+
+const array<uint64_t, max_value_sum + 1> max_magnitudes = make_max_magnitudes();
+
+// An upper bound on the magnitude of the sum of two numbers whose regular
+// numbers add up to `value_sum`. Reducing never adds to the total: explosions
+// and splits only move value around, or drop it off either end.
+uint64_t max_sum_magnitude(uint32_t value_sum) {
+  return max_magnitudes[min(value_sum, max_value_sum)];
+}
+
+// Every number from the homework in one block, which is never written to
+// after it's filled so threads can share it.
+struct NumberPool {
+  vector<Element> elements;
+  // Where each number starts, and then where the last one ends.
+  vector<size_t> offsets = {0};
+  vector<uint32_t> value_sums;
+
+  size_t size() const { return value_sums.size(); }
+
+  NumberView operator[](size_t index) const {
+    return {elements.data() + offsets[index], offsets[index + 1] - offsets[index]};
+  }
+
+  void add(const SnailfishNumber& number) {
+    uint32_t value_sum = 0;
+    for (auto e = number.begin(); e != number.end(); ++e)
+      value_sum += e->value;
+    elements.insert(elements.end(), number.begin(), number.end());
+    offsets.push_back(elements.size());
+    value_sums.push_back(value_sum);
+  }
+};
+
+// The largest magnitude of the sum of any two different numbers, in either
+// order. Numbers are tried largest total first, and a thread moves on from a
+// number once no partner left can beat the best magnitude any thread has
+// found. Each thread takes the next number as it finishes one and has its own
+// buffer for sums.
+uint64_t max_pair_magnitude(const NumberPool& pool) {
+  vector<size_t> order(pool.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  sort(order.begin(), order.end(), [&](size_t a, size_t b) { return pool.value_sums[a] > pool.value_sums[b]; });
+
+  atomic<uint64_t> best(0);
+  atomic<size_t> next_row(0);
+  auto search = [&] {
+    SnailfishNumber sum;
+    uint64_t local_best = 0;
+    for (size_t row = next_row++; row < order.size(); row = next_row++) {
+      size_t i = order[row];
+      for (size_t column = 0; column < order.size(); ++column) {
+        size_t j = order[column];
+        if (i == j)
+          continue;
+        local_best = max(local_best, best.load(memory_order_relaxed));
+        if (max_sum_magnitude(pool.value_sums[i] + pool.value_sums[j]) <= local_best)
+          break;
+        add(pool[i], pool[j], sum);
+        uint64_t sum_magnitude = magnitude(sum);
+        if (sum_magnitude > local_best) {
+          local_best = sum_magnitude;
+          uint64_t current = best.load(memory_order_relaxed);
+          while (current < local_best && !best.compare_exchange_weak(current, local_best, memory_order_relaxed)) {
+          }
+        }
+      }
+    }
+  };
+
+  const size_t min_rows_per_thread = 16;
+  size_t thread_count = max<size_t>(1, thread::hardware_concurrency());
+  thread_count = min(thread_count, max<size_t>(1, pool.size() / min_rows_per_thread));
+  vector<thread> threads;
+  for (size_t t = 1; t < thread_count; ++t)
+    threads.emplace_back(search);
+  search();
+  for (auto t = threads.begin(); t != threads.end(); ++t) {
+    t->join();
+  }
+  return best;
+}
+
+// MARK: - Parsers
+
+SnailfishNumber parse_number(const string& input) {
+  SnailfishNumber number;
+  uint8_t depth = 0;
+  for (size_t i = 0; i < input.size(); ++i) {
+    char c = input[i];
+    // Numbers are always reduced to begin with.
+    if (c == '[') {
+      if (depth == max_depth)
+        abort();
+      depth++;
+    } else if (c == ']') {
+      depth--;
+    } else if (c >= '0' && c <= '9') {
+      uint32_t value = 0;
+      for (; i < input.size() && input[i] >= '0' && input[i] <= '9'; ++i)
+        value = value * 10 + (input[i] - '0');
+      i--;
+      if (value >= min_split_value)
+        abort();
+      number.push_back({value, depth});
+    } else if (c != ',') {
+      abort();
+    }
+  }
+  return number;
+}
+
 // MARK: - Parts 1 & 2
 
-int part1() {
-  return 0;
+uint64_t part1(const NumberPool& pool) {
+  SnailfishNumber sum(pool[0].elements, pool[0].elements + pool[0].size);
+  SnailfishNumber next_sum;
+  for (size_t i = 1; i < pool.size(); ++i) {
+    add(sum, pool[i], next_sum);
+    swap(sum, next_sum);
+  }
+  return magnitude(sum);
 }
 
-int part2() {
-  return 0;
+uint64_t part2(const NumberPool& pool) {
+  return max_pair_magnitude(pool);
 }
 
 int main() {
-  cout << "Part 1: " << part1() << endl;
-  cout << "Part 1: " << part2() << endl;
+  // MARK: - Read Input
+
+  ifstream is("input.txt");
+  string str;
+  NumberPool pool;
+  while (getline(is, str)) {
+    if (!str.empty())
+      pool.add(parse_number(str));
+  }
+  if (pool.size() == 0)
+    abort();
+
+  cout << "Part 1: " << part1(pool) << endl;
+  cout << "Part 2: " << part2(pool) << endl;
   return 0;
 }
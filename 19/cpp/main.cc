@@ -1,18 +1,273 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
 using namespace std;
 
+// MARK: - Models
+
+struct Vector3 {
+  int64_t x;
+  int64_t y;
+  int64_t z;
+
+  Vector3 operator +(const Vector3& rhs) const {
+    return {x + rhs.x, y + rhs.y, z + rhs.z};
+  }
+
+  Vector3 operator -(const Vector3& rhs) const {
+    return {x - rhs.x, y - rhs.y, z - rhs.z};
+  }
+
+  bool operator ==(const Vector3& rhs) const {
+    return x == rhs.x && y == rhs.y && z == rhs.z;
+  }
+
+  bool operator <(const Vector3& rhs) const {
+    return x != rhs.x ? x < rhs.x : y != rhs.y ? y < rhs.y : z < rhs.z;
+  }
+
+  int64_t squared_length() const {
+    return x * x + y * y + z * z;
+  }
+
+  int64_t manhattan_length() const {
+    return abs(x) + abs(y) + abs(z);
+  }
+
+  // Packs the vector into a hash map key, aborting if any coordinate needs
+  // more than 21 bits.
+  uint64_t key() const {
+    const int64_t bias = 1 << 20;
+    if (abs(x) >= bias || abs(y) >= bias || abs(z) >= bias)
+      abort();
+    return (uint64_t)(x + bias) << 42 | (uint64_t)(y + bias) << 21 | (uint64_t)(z + bias);
+  }
+};
+
+// A rotation by quarter turns, as a matrix whose rows each pick one axis of
+// the rotated vector, possibly negated.
+struct Rotation {
+  int matrix[3][3];
+
+  constexpr int determinant() const {
+    return matrix[0][0] * (matrix[1][1] * matrix[2][2] - matrix[1][2] * matrix[2][1])
+      - matrix[0][1] * (matrix[1][0] * matrix[2][2] - matrix[1][2] * matrix[2][0])
+      + matrix[0][2] * (matrix[1][0] * matrix[2][1] - matrix[1][1] * matrix[2][0]);
+  }
+
+  Vector3 apply(const Vector3& v) const {
+    return {
+      matrix[0][0] * v.x + matrix[0][1] * v.y + matrix[0][2] * v.z,
+      matrix[1][0] * v.x + matrix[1][1] * v.y + matrix[1][2] * v.z,
+      matrix[2][0] * v.x + matrix[2][1] * v.y + matrix[2][2] * v.z,
+    };
+  }
+};
+
+const int rotation_count = 24;
+
+// Every way of permuting and negating the axes that doesn't mirror them.
+constexpr array<Rotation, rotation_count> make_rotations() {
+  const int permutations[6][3] = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+  array<Rotation, rotation_count> rotations = {};
+  int count = 0;
+  for (int p = 0; p < 6; ++p) {
+    for (int signs = 0; signs < 8; ++signs) {
+      Rotation rotation = {};
+      for (int row = 0; row < 3; ++row)
+        rotation.matrix[row][permutations[p][row]] = signs >> row & 1 ? -1 : 1;
+      if (rotation.determinant() == 1)
+        rotations[count++] = rotation;
+    }
+  }
+  return rotations;
+}
+
+constexpr array<Rotation, rotation_count> rotations = make_rotations();
+
+static_assert(rotations[rotation_count - 1].determinant() == 1, "Expected 24 rotations");
+
+struct Scanner {
+  vector<Vector3> beacons;
+  // The squared distance between every pair of beacons, sorted. These don't
+  // change with rotation or translation, so they fingerprint the beacons
+  // wherever the scanner happens to be.
+  vector<int64_t> distances;
+
+  void fingerprint() {
+    distances.clear();
+    for (size_t i = 0; i < beacons.size(); ++i) {
+      for (size_t j = i + 1; j < beacons.size(); ++j)
+        distances.push_back((beacons[i] - beacons[j]).squared_length());
+    }
+    sort(distances.begin(), distances.end());
+  }
+};
+
+// How many distances the two scanners have in common, counting repeats as
+// many times as both have them.
+size_t shared_distance_count(const Scanner& a, const Scanner& b) {
+  size_t count = 0;
+  auto i = a.distances.begin();
+  auto j = b.distances.begin();
+  while (i != a.distances.end() && j != b.distances.end()) {
+    if (*i < *j) {
+      ++i;
+    } else if (*j < *i) {
+      ++j;
+    } else {
+      count++;
+      ++i;
+      ++j;
+    }
+  }
+  return count;
+}
+
+// MARK: - Alignment
+
+// Scanners overlap when they see at least this many beacons in common.
+const int min_shared_beacons = 12;
+// Overlapping scanners share every distance between their common beacons.
+const size_t min_shared_distances = min_shared_beacons * (min_shared_beacons - 1) / 2;
+
+// Where a scanner is and which way it faces, relative to the first one.
+struct Placement {
+  Rotation rotation;
+  Vector3 position;
+};
+
+// Looks for a placement of `scanner` that puts at least `min_shared_beacons`
+// of its beacons on the `known` ones. For each rotation, every pair of a
+// known beacon and a rotated one votes for the offset that would put one on
+// the other, and an offset with enough votes is the scanner's position.
+bool align(const vector<Vector3>& known, const Scanner& scanner, unordered_map<uint64_t, int>& votes,
+           Placement& placement) {
+  for (auto r = rotations.begin(); r != rotations.end(); ++r) {
+    votes.clear();
+    for (auto b = scanner.beacons.begin(); b != scanner.beacons.end(); ++b) {
+      Vector3 rotated = r->apply(*b);
+      for (auto k = known.begin(); k != known.end(); ++k) {
+        Vector3 offset = *k - rotated;
+        if (++votes[offset.key()] == min_shared_beacons) {
+          placement = {*r, offset};
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+struct Map {
+  // Every beacon relative to the first scanner, sorted and without repeats.
+  vector<Vector3> beacons;
+  vector<Vector3> scanner_positions;
+};
+
+// Places every scanner relative to the first. Scanners are placed outward
+// from those already placed, and only tried against one when their
+// fingerprints share enough distances to possibly overlap.
+Map map_scanners(const vector<Scanner>& scanners) {
+  size_t count = scanners.size();
+  vector<bool> placed(count, false);
+  // Each placed scanner's beacons relative to the first scanner.
+  vector<vector<Vector3>> placed_beacons(count);
+  vector<Vector3> positions(count);
+  unordered_map<uint64_t, int> votes;
+  votes.reserve(scanners.front().beacons.size() * scanners.front().beacons.size());
+
+  placed[0] = true;
+  placed_beacons[0] = scanners[0].beacons;
+  vector<size_t> frontier = {0};
+  while (!frontier.empty()) {
+    size_t known = frontier.back();
+    frontier.pop_back();
+    for (size_t candidate = 0; candidate < count; ++candidate) {
+      if (placed[candidate] || shared_distance_count(scanners[known], scanners[candidate]) < min_shared_distances)
+        continue;
+      Placement placement;
+      if (!align(placed_beacons[known], scanners[candidate], votes, placement))
+        continue;
+      placed[candidate] = true;
+      positions[candidate] = placement.position;
+      vector<Vector3>& beacons = placed_beacons[candidate];
+      for (auto b = scanners[candidate].beacons.begin(); b != scanners[candidate].beacons.end(); ++b)
+        beacons.push_back(placement.rotation.apply(*b) + placement.position);
+      frontier.push_back(candidate);
+    }
+  }
+  if (find(placed.begin(), placed.end(), false) != placed.end())
+    abort();
+
+  Map map;
+  map.scanner_positions = positions;
+  for (auto b = placed_beacons.begin(); b != placed_beacons.end(); ++b)
+    map.beacons.insert(map.beacons.end(), b->begin(), b->end());
+  sort(map.beacons.begin(), map.beacons.end());
+  map.beacons.erase(unique(map.beacons.begin(), map.beacons.end()), map.beacons.end());
+  return map;
+}
+
+// MARK: - Parsers
+
+Vector3 parse_beacon(const string& input) {
+  Vector3 beacon;
+  char comma1, comma2;
+  istringstream is(input);
+  if (!(is >> beacon.x >> comma1 >> beacon.y >> comma2 >> beacon.z) || comma1 != ',' || comma2 != ',')
+    abort();
+  return beacon;
+}
+
 // MARK: - Parts 1 & 2
 
-int part1() {
-  return 0;
+size_t part1(const Map& map) {
+  return map.beacons.size();
 }
 
-int part2() {
-  return 0;
+int64_t part2(const Map& map) {
+  int64_t result = 0;
+  const vector<Vector3>& positions = map.scanner_positions;
+  for (size_t i = 0; i < positions.size(); ++i) {
+    for (size_t j = i + 1; j < positions.size(); ++j)
+      result = max(result, (positions[i] - positions[j]).manhattan_length());
+  }
+  return result;
 }
 
 int main() {
-  cout << "Part 1: " << part1() << endl;
-  cout << "Part 1: " << part2() << endl;
+  // MARK: - Read Input
+
+  ifstream is("input.txt");
+  string str;
+  vector<Scanner> scanners;
+  while (getline(is, str)) {
+    if (str.empty())
+      continue;
+    if (str.rfind("---", 0) == 0) {
+      scanners.emplace_back();
+    } else if (!scanners.empty()) {
+      scanners.back().beacons.push_back(parse_beacon(str));
+    } else {
+      abort();
+    }
+  }
+  if (scanners.empty())
+    abort();
+  for (auto s = scanners.begin(); s != scanners.end(); ++s)
+    s->fingerprint();
+
+  Map map = map_scanners(scanners);
+
+  cout << "Part 1: " << part1(map) << endl;
+  cout << "Part 2: " << part2(map) << endl;
   return 0;
 }
@@ -3,39 +3,50 @@
 #include <map>
 #include <string>
 #include <vector>
+#include "../../shared/cpp/big_uint.h"
 using namespace std;
 
 // MARK: - Fish Counting
 
-map<int, uint64_t> cached_count_at_age_zero_for_day = {};
-
-uint64_t fish_count(int age, int days) {
-  if (days <= age) {
-    return 1;
-  } else if (age != 0) {
-    return fish_count(0, days - age);
+// A fish of age zero turns into two fish that are 7 and 9 days away from
+// their next spawn, so what it becomes after `days` days is the sum of what
+// those two become. A fish of any other age is a fish of age zero `age` days
+// later, and stays a single fish until then.
+BigUint fish_after_days(int days, vector<int> initial_state) {
+  // How many fish of age zero each initial fish is waiting to become, keyed
+  // by the number of days left once it gets there.
+  map<int, uint64_t> fish_at_age_zero_by_days;
+  BigUint result = 0;
+  for (auto i = initial_state.begin(); i != initial_state.end(); ++i) {
+    int age = *i;
+    if (days <= age) {
+      result += 1;
+    } else {
+      fish_at_age_zero_by_days[days - age]++;
+    }
   }
 
-  if (cached_count_at_age_zero_for_day.count(days)) {
-    return cached_count_at_age_zero_for_day[days];
-  }
+  // Counts for a fish of age zero, computed upwards from one day. Only the
+  // last nine days are ever looked back at.
+  const int window = 10;
+  vector<BigUint> count_at_age_zero_for_day(window);
+  auto fish_count = [&](int age, int days) -> BigUint {
+    return days <= age ? BigUint(1) : count_at_age_zero_for_day[(days - age) % window];
+  };
 
-  uint64_t count = fish_count(7, days) + fish_count(9, days);
-  cached_count_at_age_zero_for_day[days] = count;
-  return count;
-}
-
-uint64_t fish_after_days(int days, vector<int> initial_state) {
-  uint64_t result = 0;
-  for (auto i = initial_state.begin(); i != initial_state.end(); ++i) {
-    int age = *i;
-    result += fish_count(age, days);
+  auto wanted = fish_at_age_zero_by_days.begin();
+  for (int day = 1; wanted != fish_at_age_zero_by_days.end(); ++day) {
+    count_at_age_zero_for_day[day % window] = fish_count(7, day) + fish_count(9, day);
+    if (wanted->first == day) {
+      result += count_at_age_zero_for_day[day % window] * BigUint(wanted->second);
+      ++wanted;
+    }
   }
   return result;
 }
 
 void print_fish_count(int days, vector<int> initial_state) {
-  uint64_t fish_count = fish_after_days(days, initial_state);
+  BigUint fish_count = fish_after_days(days, initial_state);
   cout << fish_count << " lantern fish after " << days << " days" << endl;
 }
 
@@ -57,7 +68,7 @@ vector<string> split(string str, string token){
     return result;
 }
 
-int main() {
+int main(int argc, char** argv) {
   // MARK: - Read Input
 
   ifstream is("input.txt");
@@ -76,6 +87,13 @@ int main() {
     }
   }
 
+  // Optionally count fish after other numbers of days, however many.
+  if (argc > 1) {
+    for (int i = 1; i < argc; ++i)
+      print_fish_count(stoi(argv[i]), initial_state);
+    return 0;
+  }
+
   print_fish_count(80, initial_state);
   print_fish_count(256, initial_state);
 
@@ -1,232 +1,198 @@
+#include <algorithm>
 #include <fstream>
 #include <iostream>
-#include <map>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 using namespace std;
 
 // MARK: - Models
 
-enum Segment { a, b, c, d, e, f, g };
-
-vector<Segment> all_segment_cases() {
-  return { Segment::a, Segment::b, Segment::c, Segment::d, Segment::e, Segment::f, Segment::g };
-}
+// One bit per segment, `a` in the lowest bit through `g` in bit 6.
+typedef uint8_t SegmentMask;
 
 enum Digit { zero, one, two, three, four, five, six, seven, eight, nine };
 
-bool segments_contains(vector<Segment> segments, vector<Segment> test) {
-  if (test.size() != segments.size()) {
-    return false;
-  }
-
-  int matches = 0;
-  for (auto i = test.begin(); i != test.end(); ++i) {
-    if (count(segments.begin(), segments.end(), *i) > 0) {
-      matches++;
-    }
-  }
-  return matches == test.size();
+int segment_count(SegmentMask mask) {
+  return __builtin_popcount(mask);
 }
 
-optional<Digit> digit_from_segments(vector<Segment> segments) {
-  if (segments_contains({Segment::a, Segment::b, Segment::c, Segment::e, Segment::f, Segment::g}, segments)) {
-    return Digit::zero;
-  } else if (segments_contains({Segment::c, Segment::f}, segments)) {
-    return Digit::one;
-  } else if (segments_contains({Segment::a, Segment::c, Segment::d, Segment::e, Segment::g}, segments)) {
-    return Digit::two;
-  } else if (segments_contains({Segment::a, Segment::c, Segment::d, Segment::f, Segment::g}, segments)) {
-    return Digit::three;
-  } else if (segments_contains({Segment::b, Segment::c, Segment::d, Segment::f}, segments)) {
-    return Digit::four;
-  } else if (segments_contains({Segment::a, Segment::b, Segment::d, Segment::f, Segment::g}, segments)) {
-    return Digit::five;
-  } else if (segments_contains({Segment::a, Segment::b, Segment::d, Segment::e, Segment::f, Segment::g}, segments)) {
-    return Digit::six;
-  } else if (segments_contains({Segment::a, Segment::c, Segment::f}, segments)) {
-    return Digit::seven;
-  } else if (segments_contains({Segment::a, Segment::b, Segment::c, Segment::d, Segment::e, Segment::f, Segment::g}, segments)) {
-    return Digit::eight;
-  } else if (segments_contains({Segment::a, Segment::b, Segment::c, Segment::d, Segment::f, Segment::g}, segments)) {
-    return Digit::nine;
-  }
-
-  return nullopt;
+bool mask_contains(SegmentMask mask, SegmentMask test) {
+  return (mask & test) == test;
 }
 
-struct SegmentMap {
-  map<Segment, Segment> map;
-};
-
-vector<SegmentMap> all_possible_segment_maps() {
-  vector<SegmentMap> all_maps;
-  vector<Segment> original_all_segment_cases = all_segment_cases();
-  vector<Segment> all_segments = all_segment_cases();
+// The ten unique signal patterns followed by the four output digits, as they
+// appear on a line.
+struct Record {
+  static const int input_count = 10;
+  static const int output_count = 4;
 
-  do {
-      SegmentMap map;
-      for (int segment_index = 0; segment_index < original_all_segment_cases.size(); ++segment_index) {
-        map.map[original_all_segment_cases[segment_index]] = all_segments[segment_index];
-      }
-      all_maps.push_back(map);
-  } while (next_permutation(all_segments.begin(), all_segments.end()));
-  return all_maps;
-}
+  SegmentMask masks[input_count + output_count];
 
-struct BrokenDigit {
-  vector<Segment> segments;
+  const SegmentMask* input() const { return masks; }
+  const SegmentMask* output() const { return masks + input_count; }
+};
 
-  optional<Digit> to_digit(SegmentMap map) {
-    vector<Segment> mapped_segments;
-    for (auto i = segments.begin(); i != segments.end(); ++i) {
-      mapped_segments.push_back(map.map[*i]);
+// Only the patterns for one and four are needed to tell every digit apart:
+// the remaining ambiguity is between digits with the same segment count, and
+// those differ in how much of one and four they cover.
+struct Decoder {
+  SegmentMask one;
+  SegmentMask four;
+
+  Digit decode(SegmentMask mask) const {
+    switch (segment_count(mask)) {
+    case 2:
+      return Digit::one;
+    case 3:
+      return Digit::seven;
+    case 4:
+      return Digit::four;
+    case 7:
+      return Digit::eight;
+    case 5:
+      if (mask_contains(mask, one))
+        return Digit::three;
+      return segment_count(mask & four) == 3 ? Digit::five : Digit::two;
+    default:
+      if (mask_contains(mask, four))
+        return Digit::nine;
+      return mask_contains(mask, one) ? Digit::zero : Digit::six;
     }
-    return digit_from_segments(mapped_segments);
   }
 };
 
-struct Line {
-  vector<BrokenDigit> input;
-  vector<BrokenDigit> output;
-
-  optional<SegmentMap> generate_segment_map() {
-    vector<SegmentMap> all_maps = all_possible_segment_maps();
-    vector<BrokenDigit> broken_digits_to_guess;
-    broken_digits_to_guess.insert(broken_digits_to_guess.end(), input.begin(), input.end());
-    broken_digits_to_guess.insert(broken_digits_to_guess.end(), output.begin(), output.end());
-    auto broken_digits_to_guess_size = broken_digits_to_guess.size();
-    for (auto m = all_maps.begin(); m != all_maps.end(); ++m) {
-      int matches = 0;
-      for (auto d = broken_digits_to_guess.begin(); d != broken_digits_to_guess.end(); ++d) {
-        if (d->to_digit(*m).has_value())
-          matches++;
-      }
-      if (matches == broken_digits_to_guess_size) {
-        return *m;
+Decoder decoder_for(const Record& record) {
+  Decoder decoder = {0, 0};
+  const SegmentMask* input = record.input();
+  for (int i = 0; i < Record::input_count; ++i) {
+    if (segment_count(input[i]) == 2) {
+      decoder.one = input[i];
+    } else if (segment_count(input[i]) == 4) {
+      decoder.four = input[i];
+    }
+  }
+  return decoder;
+}
+
+struct Totals {
+  uint64_t easy_digits;
+  uint64_t output_sum;
+
+  void add(const Record& record) {
+    Decoder decoder = decoder_for(record);
+    const SegmentMask* output = record.output();
+    uint64_t value = 0;
+    for (int i = 0; i < Record::output_count; ++i) {
+      Digit digit = decoder.decode(output[i]);
+      if (digit == Digit::one || digit == Digit::four || digit == Digit::seven || digit == Digit::eight) {
+        easy_digits++;
       }
+      value = value * 10 + digit;
     }
-    return nullopt;
+    output_sum += value;
+  }
+
+  void add(const Totals& other) {
+    easy_digits += other.easy_digits;
+    output_sum += other.output_sum;
   }
 };
 
 // MARK: - Parsers
 
-vector<string> split(string str, string token) {
-  vector<string> result;
-  while (str.size()) {
-    int index = str.find(token);
-    if (index != string::npos) {
-      result.push_back(str.substr(0,index));
-      str = str.substr(index+token.size());
-      if (str.empty()) result.push_back(str);
-    } else {
-      result.push_back(str);
-      str = "";
+// Parses the line starting at `cursor` into `record` and advances `cursor`
+// past its newline. Returns false for blank or malformed lines.
+bool parse_record(const char*& cursor, const char* end, Record& record) {
+  int index = 0;
+  SegmentMask mask = 0;
+  for (; cursor != end && *cursor != '\n'; ++cursor) {
+    char c = *cursor;
+    if (c >= 'a' && c <= 'g') {
+      mask |= 1 << (c - 'a');
+    } else if (mask != 0) {
+      if (index < Record::input_count + Record::output_count)
+        record.masks[index] = mask;
+      index++;
+      mask = 0;
     }
   }
-  return result;
-}
-
-optional<Segment> parse_segment(char input) {
-  if (input == 'a') {
-    return Segment::a;
-  } else if (input == 'b') {
-    return Segment::b;
-  } else if (input == 'c') {
-    return Segment::c;
-  } else if (input == 'd') {
-    return Segment::d;
-  } else if (input == 'e') {
-    return Segment::e;
-  } else if (input == 'f') {
-    return Segment::f;
-  } else if (input == 'g') {
-    return Segment::g;
+  if (mask != 0) {
+    if (index < Record::input_count + Record::output_count)
+      record.masks[index] = mask;
+    index++;
   }
-  return nullopt;
+  if (cursor != end)
+    ++cursor;
+  return index == Record::input_count + Record::output_count;
 }
 
-BrokenDigit parse_digit(string input) {
-  vector<Segment> segments;
-  for (auto i = input.begin(); i != input.end(); ++i) {
-    optional<Segment> parsed_segment = parse_segment(*i);
-    if (parsed_segment.has_value()) {
-      segments.push_back(*parsed_segment);
-    }
+Totals decode_chunk(const char* begin, const char* end) {
+  Totals totals = {0, 0};
+  Record record;
+  while (begin != end) {
+    if (parse_record(begin, end, record))
+      totals.add(record);
   }
-  return BrokenDigit{segments};
+  return totals;
 }
 
-vector<BrokenDigit> parse_digits(string input) {
-  vector<string> digits_strings = split(input, " ");
-  vector<BrokenDigit> digits;
-  for (auto i = digits_strings.begin(); i != digits_strings.end(); ++i) {
-    digits.push_back(parse_digit(*i));
+// Splits the buffer on line boundaries and decodes each chunk on its own
+// thread. Lines are independent, so the only shared state is the final merge.
+Totals decode_all(const string& input) {
+  const char* begin = input.data();
+  const char* end = begin + input.size();
+
+  const size_t min_chunk_size = 1 << 16;
+  size_t thread_count = max<size_t>(1, thread::hardware_concurrency());
+  thread_count = min(thread_count, max<size_t>(1, input.size() / min_chunk_size));
+
+  vector<const char*> boundaries = {begin};
+  for (size_t i = 1; i < thread_count; ++i) {
+    const char* boundary = max(boundaries.back(), begin + input.size() * i / thread_count);
+    boundary = find(boundary, end, '\n');
+    boundaries.push_back(boundary == end ? end : boundary + 1);
+  }
+  boundaries.push_back(end);
+
+  vector<Totals> chunk_totals(thread_count, {0, 0});
+  vector<thread> threads;
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads.emplace_back([&, i] {
+      chunk_totals[i] = decode_chunk(boundaries[i], boundaries[i + 1]);
+    });
   }
-  return digits;
-}
 
-Line parse_line(string input) {
-  vector<string> components = split(input, " | ");
-  return Line{parse_digits(components[0]), parse_digits(components[1])};
+  Totals totals = {0, 0};
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads[i].join();
+    totals.add(chunk_totals[i]);
+  }
+  return totals;
 }
 
 // MARK: - Parts 1 & 2
 
-int part1(vector<vector<Digit>> output) {
-  int count = 0;
-  for (auto i = output.begin(); i != output.end(); ++i) {
-    for (auto d = i->begin(); d != i->end(); ++d) {
-      if (*d == Digit::one || *d == Digit::four || *d == Digit::seven || *d == Digit::eight) {
-        count++;
-      }
-    }
-  }
-  return count;
+uint64_t part1(const Totals& totals) {
+  return totals.easy_digits;
 }
 
-int part2(vector<vector<Digit>> output) {
-  int sum = 0;
-  for (auto i = output.begin(); i != output.end(); ++i) {
-    int current_sum = 0;
-    for (auto d = i->begin(); d != i->end(); ++d) {
-      current_sum *= 10;
-      current_sum += *d;
-    }
-    sum += current_sum;
-  }
-  return sum;
+uint64_t part2(const Totals& totals) {
+  return totals.output_sum;
 }
 
 int main() {
   // MARK: - Read Input
 
   ifstream is("input.txt");
-  string str;
-  vector<Line> parsed_input;
-  while(getline(is, str)) {
-    parsed_input.push_back(parse_line(str));
-  }
+  stringstream buffer;
+  buffer << is.rdbuf();
+  string input = buffer.str();
 
-  vector<vector<Digit>> corrected_output;
-
-  for (auto line = parsed_input.begin(); line != parsed_input.end(); ++line) {
-    optional<SegmentMap> segment_map = line->generate_segment_map();
-    if (segment_map.has_value()) {
-      vector<Digit> corrected_digits;
-      for (auto o = line->output.begin(); o != line->output.end(); ++o) {
-        optional<Digit> corrected_digit = o->to_digit(*segment_map);
-        if (corrected_digit.has_value()) {
-          corrected_digits.push_back(*corrected_digit);
-        }
-      }
-      corrected_output.push_back(corrected_digits);
-    }
-  }
+  Totals totals = decode_all(input);
 
-  cout << "Part 1: " << part1(corrected_output) << endl;
-  cout << "Part 2: " << part2(corrected_output) << endl;
+  cout << "Part 1: " << part1(totals) << endl;
+  cout << "Part 2: " << part2(totals) << endl;
   return 0;
 }
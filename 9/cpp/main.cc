@@ -1,8 +1,11 @@
+#include <algorithm>
+#include <cstdint>
 #include <fstream>
+#include <functional>
 #include <iostream>
-#include <map>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 using namespace std;
 
@@ -21,280 +24,284 @@ struct Point {
   }
 };
 
-enum Height { zero, one, two, three, four, five, six, seven, eight, nine };
+typedef uint8_t Height;
 
-int height_to_raw_value(Height height) {
-  switch (height) {
-  case zero:
-    return 0;
-  case one:
-    return 1;
-  case two:
-    return 2;
-  case three:
-    return 3;
-  case four:
-    return 4;
-  case five:
-    return 5;
-  case six:
-    return 6;
-  case seven:
-    return 7;
-  case eight:
-    return 8;
-  case nine:
-    return 9;
-  }
-}
+const Height max_height = 9;
 
 int height_to_risk_level(Height height) {
-  return height_to_raw_value(height) + 1;
+  return height + 1;
 }
 
-struct Line {
-  vector<Height> points;
-};
-
-struct PointWithHeight {
-  Point point;
-  Height height;
-
-  bool operator <(const PointWithHeight& rhs) const {
-    return point < rhs.point || (point == rhs.point && height_to_raw_value(height) < height_to_raw_value(rhs.height));
-  }
+// Every cell's basin, indexed like `Grid::cells`. Nines and the border are
+// labeled `wall`, every other cell with a dense basin id that indexes `sizes`.
+struct BasinLabels {
+  static constexpr int wall = -1;
 
-  bool operator ==(const PointWithHeight& rhs) const {
-    return point == rhs.point && height_to_raw_value(height) == height_to_raw_value(rhs.height);
-  }
+  vector<int> labels;
+  vector<int> sizes;
 };
 
-vector<PointWithHeight> low_point_candidates(vector<PointWithHeight> input) {
-  vector<PointWithHeight> results;
-  for (int i = 0; i < input.size() - 2; ++i) {
-    if (input[i].height > input[i + 1].height && input[i + 2].height > input[i + 1].height)
-      results.push_back(input[i + 1]);
+// Compares a whole row against the rows above and below and its own shifted
+// copies. Rows must have a `max_height` cell on either side. The loop body is
+// branch-free so the compiler can vectorize it.
+template <typename Visitor>
+void visit_low_points_in_row(const Height* above, const Height* row, const Height* below, int width, Visitor visit) {
+  for (int x = 0; x < width; ++x) {
+    Height h = row[x];
+    bool is_low = (h < above[x]) & (h < below[x]) & (h < row[x - 1]) & (h < row[x + 1]);
+    visit(x, h, is_low);
   }
+}
 
-  if (input[0].height < input[1].height)
-    results.push_back(input[0]);
+uint64_t row_risk_level_sum(const Height* above, const Height* row, const Height* below, int width) {
+  uint64_t sum = 0;
+  visit_low_points_in_row(above, row, below, width, [&](int, Height h, bool is_low) {
+    sum += is_low * height_to_risk_level(h);
+  });
+  return sum;
+}
 
-  if (input[input.size() - 1].height < input[input.size() - 2].height)
-    results.push_back(input[input.size() - 1]);
+// Heights stored row-major with a one-cell border of `max_height` on every
+// side, so neighbors can be read without bounds checks. A border of nines
+// never makes a cell a low point that wouldn't be one otherwise, since a nine
+// can't be lower than its neighbors and every other height is below nine.
+struct Grid {
+  int width;
+  int height;
+  vector<Height> cells;
 
-  return results;
-}
+  int stride() const { return width + 2; }
 
-struct Basin {
-  vector<PointWithHeight> points;
+  int index(Point point) const {
+    return (point.y + 1) * stride() + point.x + 1;
+  }
 
-  int size() { return points.size(); }
-};
+  uint64_t risk_level_sum() const {
+    uint64_t sum = 0;
+    for (int y = 0; y < height; ++y) {
+      sum += row_risk_level_sum(&cells[index({0, y - 1})], &cells[index({0, y})], &cells[index({0, y + 1})], width);
+    }
+    return sum;
+  }
 
-vector<PointWithHeight> points_adjacent_to(Point point, vector<PointWithHeight> input) {
-  vector<Point> adjacent_positions = {
-    {point.x + 1, point.y},
-    {point.x - 1, point.y},
-    {point.x, point.y + 1},
-    {point.x, point.y - 1},
-  };
+  BasinLabels label_basins(int thread_count = 1) const;
+};
 
-  vector<PointWithHeight> results;
-  for (auto i = adjacent_positions.begin(); i != adjacent_positions.end(); ++i)
-    for (auto p = input.begin(); p != input.end(); ++p)
-      if (*i == p->point)
-        results.push_back(*p);
+// MARK: - Basin Labeling
 
-  return results;
-}
+// Union-find over cell indices. Roots are always the smallest index in their
+// set, so unions within disjoint row bands never touch each other's cells.
+struct DisjointSet {
+  vector<int> parent;
 
-vector<PointWithHeight> points_adjacent_to(vector<PointWithHeight> points, vector<PointWithHeight> input) {
-  vector<PointWithHeight> results;
-  for (auto p = points.begin(); p != points.end(); ++p) {
-    vector<PointWithHeight> adjacent_points = points_adjacent_to(p->point, input);
-    results.insert(results.end(), adjacent_points.begin(), adjacent_points.end());
+  int find(int i) {
+    while (parent[i] != i) {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
   }
-  unique(results.begin(), results.end());
-  auto it = unique(results.begin(), results.end());
-  results.resize(distance(results.begin(), it));
-  return results;
-}
 
-struct Grid {
-  map<Point, Height> points;
-  Point max_point;
-
-  vector<PointWithHeight> get_low_points() {
-    vector<PointWithHeight> x_low_point_candidates;
-    for (int y = 0; y <= max_point.y; ++y) {
-      vector<PointWithHeight> points_matching_y;
-      for (auto p = points.begin(); p != points.end(); ++p)
-        if (p->first.y == y)
-          points_matching_y.push_back({p->first, p->second});
-
-      sort(points_matching_y.begin(), points_matching_y.end());
-      auto candidates = low_point_candidates(points_matching_y);
-      for (auto c = candidates.begin(); c != candidates.end(); ++c)
-        x_low_point_candidates.push_back(*c);
-    }
+  int find_without_compressing(int i) const {
+    while (parent[i] != i)
+      i = parent[i];
+    return i;
+  }
 
-    vector<PointWithHeight> y_low_point_candidates;
-    for (int x = 0; x <= max_point.x; ++x) {
-      vector<PointWithHeight> points_matching_x;
-      for (auto p = points.begin(); p != points.end(); ++p)
-        if (p->first.x == x)
-          points_matching_x.push_back({p->first, p->second});
-
-      sort(points_matching_x.begin(), points_matching_x.end());
-      auto candidates = low_point_candidates(points_matching_x);
-      for (auto c = candidates.begin(); c != candidates.end(); ++c)
-        y_low_point_candidates.push_back(*c);
+  void unite(int a, int b) {
+    a = find(a);
+    b = find(b);
+    if (a < b) {
+      parent[b] = a;
+    } else if (b < a) {
+      parent[a] = b;
     }
+  }
+};
 
-    sort(x_low_point_candidates.begin(), x_low_point_candidates.end());
-    sort(y_low_point_candidates.begin(), y_low_point_candidates.end());
-    
-    vector<PointWithHeight> result;
-    set_intersection(x_low_point_candidates.begin(), x_low_point_candidates.end(),
-                     y_low_point_candidates.begin(), y_low_point_candidates.end(),
-                     back_inserter(result));
-    sort(result.begin(), result.end());
-    return result;
+// Runs `work(band, first_row, end_row)` over `thread_count` bands of rows.
+template <typename Work>
+void for_each_row_band(int height, int thread_count, Work work) {
+  thread_count = max(1, min(thread_count, height));
+  vector<thread> threads;
+  for (int band = 0; band < thread_count; ++band) {
+    int first_row = height * band / thread_count;
+    int end_row = height * (band + 1) / thread_count;
+    threads.emplace_back(work, band, first_row, end_row);
+  }
+  for (auto t = threads.begin(); t != threads.end(); ++t) {
+    t->join();
   }
+}
 
-  vector<Basin> get_basins() {
-    vector<Basin> result;
-    vector<PointWithHeight> eligible_points;
-    for (auto i = points.begin(); i != points.end(); ++i)
-      if (i->second != nine)
-        eligible_points.push_back({i->first, i->second});
-
-    vector<PointWithHeight> low_points = get_low_points();
-    for (auto p = low_points.begin(); p != low_points.end(); ++p) {
-      eligible_points.erase(
-        remove(eligible_points.begin(), eligible_points.end(), *p),
-        eligible_points.end()
-      );
-
-      vector<PointWithHeight> basin_points = {*p};
-      bool finished_basin = false;
-      while (!finished_basin) {
-        vector<PointWithHeight> adjacent_points = points_adjacent_to(basin_points, eligible_points);
-        if (adjacent_points.empty()) {
-          finished_basin = true;
-        } else {
-          basin_points.insert(basin_points.end(), adjacent_points.begin(), adjacent_points.end());
-          auto it = eligible_points.begin();
-          while (it != eligible_points.end()) {
-            if (count(adjacent_points.begin(), adjacent_points.end(), *it) > 0) {
-              it = eligible_points.erase(it);
-            } else {
-              ++it;
-            }
-          }
-        }
-      }
+// Two-pass connected-component labeling with nines as walls. The first pass
+// unites each cell with its left and upper neighbors, band by band, and then
+// the band borders are stitched together. The second pass resolves every
+// cell to its root, which no longer changes, so bands can read it in
+// parallel, and basin sizes are then counted from the labels.
+BasinLabels Grid::label_basins(int thread_count) const {
+  thread_count = max(1, min(thread_count, height));
+  const int stride = this->stride();
+  DisjointSet set = {vector<int>(cells.size())};
+  for (int i = 0; i < (int)cells.size(); ++i) {
+    set.parent[i] = i;
+  }
 
-      vector<PointWithHeight> unique_basin_points;
-      for (auto bp = basin_points.begin(); bp != basin_points.end(); ++bp) {
-        if (count(unique_basin_points.begin(), unique_basin_points.end(), *bp) == 0)
-          unique_basin_points.push_back(*bp);
+  for_each_row_band(height, thread_count, [&](int, int first_row, int end_row) {
+    for (int y = first_row; y < end_row; ++y) {
+      for (int i = index({0, y}), end = i + width; i < end; ++i) {
+        if (cells[i] == max_height)
+          continue;
+        if (cells[i - 1] != max_height)
+          set.unite(i - 1, i);
+        if (y > first_row && cells[i - stride] != max_height)
+          set.unite(i - stride, i);
       }
-
-      result.push_back({unique_basin_points});
     }
+  });
 
-    assert(eligible_points.empty());
-    return result;
+  for (int band = 1; band < thread_count; ++band) {
+    int y = height * band / thread_count;
+    for (int i = index({0, y}), end = i + width; i < end; ++i) {
+      if (cells[i] != max_height && cells[i - stride] != max_height)
+        set.unite(i - stride, i);
+    }
   }
-};
 
-Grid grid_from_lines(vector<Line> lines) {
-  map<Point, Height> points;
-  for (int y = 0; y < lines.size(); ++y) {
-    Line line = lines[y];
-    for (int x = 0; x < line.points.size(); ++x) {
-      points[{x, y}] = line.points[x];
+  BasinLabels result = {vector<int>(cells.size(), BasinLabels::wall), {}};
+  vector<int> basin_for_root(cells.size(), BasinLabels::wall);
+  for (int i = 0; i < (int)cells.size(); ++i) {
+    if (cells[i] != max_height && set.parent[i] == i) {
+      basin_for_root[i] = result.sizes.size();
+      result.sizes.push_back(0);
     }
   }
 
-  Point max_point = points.rbegin()->first;
-  return {points, max_point};
+  for_each_row_band(height, thread_count, [&](int, int first_row, int end_row) {
+    for (int y = first_row; y < end_row; ++y) {
+      for (int i = index({0, y}), end = i + width; i < end; ++i) {
+        if (cells[i] != max_height)
+          result.labels[i] = basin_for_root[set.find_without_compressing(i)];
+      }
+    }
+  });
+
+  for (auto label = result.labels.begin(); label != result.labels.end(); ++label) {
+    if (*label != BasinLabels::wall)
+      result.sizes[*label]++;
+  }
+  return result;
 }
 
 // MARK: - Parsers
 
 Height parse_height(char input) {
-  switch (input) {
-  case '0':
-    return Height::zero;
-  case '1':
-    return Height::one;
-  case '2':
-    return Height::two;
-  case '3':
-    return Height::three;
-  case '4':
-    return Height::four;
-  case '5':
-    return Height::five;
-  case '6':
-    return Height::six;
-  case '7':
-    return Height::seven;
-  case '8':
-    return Height::eight;
-  case '9':
-    return Height::nine;
-  default:
+  if (input < '0' || input > '9')
     abort();
-  }
+  return input - '0';
 }
 
-Line parse_line(string input) {
-  vector<Height> points;
-  for (auto i = input.begin(); i != input.end(); ++i) {
-    points.push_back(parse_height(*i));
+Grid parse_grid(const string& input) {
+  vector<string> rows;
+  istringstream is(input);
+  string str;
+  while (getline(is, str)) {
+    if (!str.empty())
+      rows.push_back(str);
+  }
+
+  Grid grid = {rows.empty() ? 0 : (int)rows[0].size(), (int)rows.size(), {}};
+  grid.cells.assign((grid.width + 2) * (grid.height + 2), max_height);
+  for (int y = 0; y < grid.height; ++y) {
+    if ((int)rows[y].size() != grid.width)
+      abort();
+    for (int x = 0; x < grid.width; ++x) {
+      grid.cells[grid.index({x, y})] = parse_height(rows[y][x]);
+    }
   }
-  return {points};
+  return grid;
 }
 
-// MARK: - Parts 1 & 2
+// Sums the risk levels of every low point while reading one row at a time,
+// keeping only the previous, current and next rows in memory.
+uint64_t streaming_risk_level_sum(istream& is) {
+  string str;
+  while (getline(is, str) && str.empty()) {}
+  int width = str.size();
+  if (width == 0)
+    return 0;
 
-int part1(Grid grid) {
-  auto low_points = grid.get_low_points();
-  int sum = 0;
-  for (auto i = low_points.begin(); i != low_points.end(); ++i) {
-    sum += height_to_risk_level(i->height);
+  // Padded rows, cycled through as the window moves down the map.
+  vector<Height> rows[3];
+  for (int i = 0; i < 3; ++i) {
+    rows[i].assign(width + 2, max_height);
+  }
+  vector<Height>* above = &rows[0];
+  vector<Height>* current = &rows[1];
+  vector<Height>* below = &rows[2];
+
+  auto parse_row_into = [&](vector<Height>* row) {
+    if ((int)str.size() != width)
+      abort();
+    for (int x = 0; x < width; ++x) {
+      (*row)[x + 1] = parse_height(str[x]);
+    }
+  };
+
+  parse_row_into(current);
+  uint64_t sum = 0;
+  bool has_next_row = true;
+  while (has_next_row) {
+    has_next_row = getline(is, str) && !str.empty();
+    if (has_next_row) {
+      parse_row_into(below);
+    } else {
+      fill(below->begin(), below->end(), max_height);
+    }
+    sum += row_risk_level_sum(&(*above)[1], &(*current)[1], &(*below)[1], width);
+
+    vector<Height>* recycled = above;
+    above = current;
+    current = below;
+    below = recycled;
   }
   return sum;
 }
 
-int part2(Grid grid) {
-  auto basins = grid.get_basins();
-  vector<int> basin_sizes;
-  for (auto i = basins.begin(); i != basins.end(); ++i) {
-    basin_sizes.push_back(i->size());
-  }
+// MARK: - Parts 1 & 2
 
-  sort(basin_sizes.begin(), basin_sizes.end());
-  int result = basin_sizes[basins.size() - 1];
-  result *= basin_sizes[basins.size() - 2];
-  result *= basin_sizes[basins.size() - 3];
+uint64_t part1(const Grid& grid) {
+  return grid.risk_level_sum();
+}
+
+uint64_t part2(const Grid& grid) {
+  int thread_count = max(1u, thread::hardware_concurrency());
+  vector<int> basin_sizes = grid.label_basins(thread_count).sizes;
+  if (basin_sizes.size() < 3)
+    abort();
+  partial_sort(basin_sizes.begin(), basin_sizes.begin() + 3, basin_sizes.end(), greater<int>());
+  uint64_t result = basin_sizes[0];
+  result *= basin_sizes[1];
+  result *= basin_sizes[2];
   return result;
 }
 
-int main() {
+int main(int argc, char** argv) {
   // MARK: - Read Input
 
   ifstream is("input.txt");
-  string str;
-  vector<Line> parsed_lines;
-  while(getline(is, str)) {
-    parsed_lines.push_back(parse_line(str));
+
+  // Part 1 only needs three rows at a time, so it can run over maps that
+  // don't fit in memory.
+  if (argc > 1 && string(argv[1]) == "--stream") {
+    cout << "Part 1: " << streaming_risk_level_sum(is) << endl;
+    return 0;
   }
 
-  Grid grid = grid_from_lines(parsed_lines);
+  stringstream buffer;
+  buffer << is.rdbuf();
+
+  Grid grid = parse_grid(buffer.str());
 
   cout << "Part 1: " << part1(grid) << endl;
   cout << "Part 2: " << part2(grid) << endl;
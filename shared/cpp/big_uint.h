@@ -0,0 +1,323 @@
+#ifndef AOC_BIG_UINT_H
+#define AOC_BIG_UINT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// MARK: - BigUint
+
+// An arbitrary-precision unsigned integer stored as base-2^64 limbs, least
+// significant first. Values of up to `inline_capacity` limbs are stored in
+// the object itself and never allocate, so counters that usually stay small
+// cost little more than a built-in integer. Decimal is only produced when the
+// value is written out.
+class BigUint {
+public:
+  static constexpr size_t inline_capacity = 2;
+
+  BigUint(uint64_t value = 0) : length(0) {
+    if (value != 0) {
+      inline_limbs[0] = value;
+      length = 1;
+    }
+  }
+
+  bool is_zero() const { return length == 0; }
+
+  size_t limb_count() const { return length; }
+
+  // Aborts if the value doesn't fit.
+  uint64_t to_uint64() const {
+    if (length > 1)
+      abort();
+    return length == 0 ? 0 : limbs()[0];
+  }
+
+  // MARK: Addition and Subtraction
+
+  BigUint& operator +=(const BigUint& rhs) {
+    if (this == &rhs) {
+      BigUint copy = rhs;
+      return *this += copy;
+    }
+    size_t rhs_length = rhs.length;
+    resize(std::max(length, rhs_length) + 1);
+    uint64_t* a = limbs();
+    const uint64_t* b = rhs.limbs();
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < rhs_length; ++i) {
+      unsigned __int128 sum = (unsigned __int128)a[i] + b[i] + carry;
+      a[i] = (uint64_t)sum;
+      carry = sum >> 64;
+    }
+    for (; carry && i < length; ++i) {
+      carry = ++a[i] == 0;
+    }
+    trim();
+    return *this;
+  }
+
+  // Aborts if `rhs` is larger, since the result can't be negative.
+  BigUint& operator -=(const BigUint& rhs) {
+    if (*this < rhs)
+      abort();
+    uint64_t* a = limbs();
+    const uint64_t* b = rhs.limbs();
+    uint64_t borrow = 0;
+    size_t i = 0;
+    for (; i < rhs.length; ++i) {
+      uint64_t subtrahend = b[i] + borrow;
+      uint64_t next_borrow = (subtrahend < borrow) | (a[i] < subtrahend);
+      a[i] -= subtrahend;
+      borrow = next_borrow;
+    }
+    for (; borrow && i < length; ++i) {
+      borrow = a[i]-- == 0;
+    }
+    trim();
+    return *this;
+  }
+
+  friend BigUint operator +(BigUint lhs, const BigUint& rhs) { return lhs += rhs; }
+  friend BigUint operator -(BigUint lhs, const BigUint& rhs) { return lhs -= rhs; }
+
+  // MARK: Multiplication and Division
+
+  BigUint& operator *=(const BigUint& rhs) {
+    if (is_zero() || rhs.is_zero()) {
+      length = 0;
+      heap_limbs.clear();
+      return *this;
+    }
+
+    std::vector<uint64_t> product(length + rhs.length, 0);
+    multiply_limbs(limbs(), length, rhs.limbs(), rhs.length, product.data());
+    assign_limbs(product);
+    return *this;
+  }
+
+  friend BigUint operator *(const BigUint& lhs, const BigUint& rhs) {
+    BigUint result = lhs;
+    return result *= rhs;
+  }
+
+  // Divides in place by a single limb and returns the remainder.
+  uint64_t divmod(uint64_t divisor) {
+    if (divisor == 0)
+      abort();
+    uint64_t* a = limbs();
+    uint64_t remainder = 0;
+    for (size_t i = length; i-- > 0;) {
+      unsigned __int128 current = ((unsigned __int128)remainder << 64) | a[i];
+      a[i] = (uint64_t)(current / divisor);
+      remainder = (uint64_t)(current % divisor);
+    }
+    trim();
+    return remainder;
+  }
+
+  // MARK: Comparison
+
+  friend bool operator ==(const BigUint& lhs, const BigUint& rhs) {
+    return lhs.length == rhs.length && std::equal(lhs.limbs(), lhs.limbs() + lhs.length, rhs.limbs());
+  }
+
+  friend bool operator !=(const BigUint& lhs, const BigUint& rhs) { return !(lhs == rhs); }
+
+  friend bool operator <(const BigUint& lhs, const BigUint& rhs) {
+    if (lhs.length != rhs.length)
+      return lhs.length < rhs.length;
+    for (size_t i = lhs.length; i-- > 0;) {
+      if (lhs.limbs()[i] != rhs.limbs()[i])
+        return lhs.limbs()[i] < rhs.limbs()[i];
+    }
+    return false;
+  }
+
+  friend bool operator >(const BigUint& lhs, const BigUint& rhs) { return rhs < lhs; }
+  friend bool operator <=(const BigUint& lhs, const BigUint& rhs) { return !(rhs < lhs); }
+  friend bool operator >=(const BigUint& lhs, const BigUint& rhs) { return !(lhs < rhs); }
+
+  // MARK: Read and Write
+
+  std::string to_string() const {
+    // The largest power of ten that fits in a limb.
+    const uint64_t chunk_divisor = 10000000000000000000ull;
+    const int chunk_digits = 19;
+
+    if (is_zero())
+      return "0";
+
+    std::vector<uint64_t> chunks;
+    BigUint remaining = *this;
+    while (!remaining.is_zero())
+      chunks.push_back(remaining.divmod(chunk_divisor));
+
+    std::string result = std::to_string(chunks.back());
+    for (size_t i = chunks.size() - 1; i-- > 0;) {
+      std::string chunk = std::to_string(chunks[i]);
+      result.append(chunk_digits - chunk.size(), '0');
+      result += chunk;
+    }
+    return result;
+  }
+
+  friend std::ostream& operator <<(std::ostream& out, const BigUint& value) {
+    return out << value.to_string();
+  }
+
+private:
+  // Operands at least this many limbs long are multiplied with Karatsuba.
+  static constexpr size_t karatsuba_threshold = 32;
+
+  size_t length;
+  uint64_t inline_limbs[inline_capacity];
+  // Holds the limbs instead of `inline_limbs` once a value outgrows them.
+  std::vector<uint64_t> heap_limbs;
+
+  uint64_t* limbs() { return heap_limbs.empty() ? inline_limbs : heap_limbs.data(); }
+  const uint64_t* limbs() const { return heap_limbs.empty() ? inline_limbs : heap_limbs.data(); }
+
+  // Changes the number of limbs, zero-filling any new ones.
+  void resize(size_t new_length) {
+    if (heap_limbs.empty() && new_length <= inline_capacity) {
+      std::fill(inline_limbs + std::min(length, new_length), inline_limbs + new_length, 0);
+    } else if (heap_limbs.empty()) {
+      heap_limbs.assign(inline_limbs, inline_limbs + length);
+      heap_limbs.resize(new_length, 0);
+    } else {
+      heap_limbs.resize(new_length, 0);
+    }
+    length = new_length;
+  }
+
+  void trim() {
+    const uint64_t* a = limbs();
+    size_t new_length = length;
+    while (new_length > 0 && a[new_length - 1] == 0)
+      new_length--;
+    if (!heap_limbs.empty() && new_length <= inline_capacity) {
+      std::copy(heap_limbs.begin(), heap_limbs.begin() + new_length, inline_limbs);
+      heap_limbs.clear();
+      heap_limbs.shrink_to_fit();
+    } else if (!heap_limbs.empty()) {
+      heap_limbs.resize(new_length);
+    }
+    length = new_length;
+  }
+
+  void assign_limbs(std::vector<uint64_t>& new_limbs) {
+    if (new_limbs.size() > inline_capacity) {
+      heap_limbs.swap(new_limbs);
+      length = heap_limbs.size();
+    } else {
+      heap_limbs.clear();
+      std::copy(new_limbs.begin(), new_limbs.end(), inline_limbs);
+      length = new_limbs.size();
+    }
+    trim();
+  }
+
+  // `out[0..n)` += `a[0..n)`, returning the carry.
+  static uint64_t add_limbs(uint64_t* out, const uint64_t* a, size_t n) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+      unsigned __int128 sum = (unsigned __int128)out[i] + a[i] + carry;
+      out[i] = (uint64_t)sum;
+      carry = sum >> 64;
+    }
+    return carry;
+  }
+
+  // Adds `a[0..n)` into `out`, propagating the carry as far as needed.
+  static void accumulate_limbs(uint64_t* out, size_t out_length, const uint64_t* a, size_t n) {
+    uint64_t carry = add_limbs(out, a, n);
+    for (size_t i = n; carry && i < out_length; ++i)
+      carry = ++out[i] == 0;
+  }
+
+  // `out[0..n)` -= `a[0..n)`, for an `out` that's at least as large.
+  static void subtract_limbs(uint64_t* out, size_t out_length, const uint64_t* a, size_t n) {
+    uint64_t borrow = 0;
+    size_t i = 0;
+    for (; i < n; ++i) {
+      uint64_t subtrahend = a[i] + borrow;
+      uint64_t next_borrow = (subtrahend < borrow) | (out[i] < subtrahend);
+      out[i] -= subtrahend;
+      borrow = next_borrow;
+    }
+    for (; borrow && i < out_length; ++i)
+      borrow = out[i]-- == 0;
+  }
+
+  static void multiply_schoolbook(const uint64_t* a, size_t n, const uint64_t* b, size_t m, uint64_t* out) {
+    for (size_t i = 0; i < n; ++i) {
+      uint64_t carry = 0;
+      for (size_t j = 0; j < m; ++j) {
+        unsigned __int128 product = (unsigned __int128)a[i] * b[j] + out[i + j] + carry;
+        out[i + j] = (uint64_t)product;
+        carry = product >> 64;
+      }
+      out[i + m] = carry;
+    }
+  }
+
+  // Writes `a * b` into the zeroed `out[0..n + m)`.
+  static void multiply_limbs(const uint64_t* a, size_t n, const uint64_t* b, size_t m, uint64_t* out) {
+    if (n < m) {
+      std::swap(a, b);
+      std::swap(n, m);
+    }
+    if (m < karatsuba_threshold) {
+      multiply_schoolbook(a, n, b, m, out);
+      return;
+    }
+
+    // Split both at `half` limbs: a = a1 * B^half + a0, b = b1 * B^half + b0.
+    size_t half = n / 2;
+    if (m <= half) {
+      // `b` is too short to split, so multiply it by each half of `a`.
+      multiply_limbs(a, half, b, m, out);
+      std::vector<uint64_t> high(n - half + m, 0);
+      multiply_limbs(a + half, n - half, b, m, high.data());
+      accumulate_limbs(out + half, n + m - half, high.data(), high.size());
+      return;
+    }
+
+    const uint64_t* a0 = a;
+    const uint64_t* a1 = a + half;
+    const uint64_t* b0 = b;
+    const uint64_t* b1 = b + half;
+    size_t a1_length = n - half;
+    size_t b1_length = m - half;
+
+    // z0 = a0 * b0 and z2 = a1 * b1 go straight into their places in `out`.
+    multiply_limbs(a0, half, b0, half, out);
+    multiply_limbs(a1, a1_length, b1, b1_length, out + 2 * half);
+
+    // z1 = (a0 + a1)(b0 + b1) - z0 - z2
+    std::vector<uint64_t> a_sum(a1_length + 1, 0);
+    std::copy(a1, a1 + a1_length, a_sum.begin());
+    accumulate_limbs(a_sum.data(), a_sum.size(), a0, half);
+    std::vector<uint64_t> b_sum(std::max(half, b1_length) + 1, 0);
+    std::copy(b0, b0 + half, b_sum.begin());
+    accumulate_limbs(b_sum.data(), b_sum.size(), b1, b1_length);
+
+    std::vector<uint64_t> z1(a_sum.size() + b_sum.size(), 0);
+    multiply_limbs(a_sum.data(), a_sum.size(), b_sum.data(), b_sum.size(), z1.data());
+    subtract_limbs(z1.data(), z1.size(), out, 2 * half);
+    subtract_limbs(z1.data(), z1.size(), out + 2 * half, a1_length + b1_length);
+
+    size_t z1_length = z1.size();
+    while (z1_length > 0 && z1[z1_length - 1] == 0)
+      z1_length--;
+    accumulate_limbs(out + half, n + m - half, z1.data(), z1_length);
+  }
+};
+
+#endif